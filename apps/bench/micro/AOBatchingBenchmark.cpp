@@ -0,0 +1,142 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file AOBatchingBenchmark.cpp Compares tracing the ambient occlusion
+    rays of the 'ao' and 'scivis' renderers one sample at a time against
+    tracing them in sorted batches (see the 'aoBatching' renderer
+    parameter), on a cluttered field of spheres over a ground plane.
+
+    It also prints the rays per second of each mode, counting the
+    primary ray of every pixel and 'aoSamples' occlusion rays for every
+    pixel that hit geometry. */
+
+#include "RenderFixture.h"
+
+// std
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+static const int numSpheres = 20000;
+static const int aoSamples = 8;
+static const int numFrames = 10;
+
+static OSPModel    model    = nullptr;
+static OSPCamera   camera   = nullptr;
+static OSPRenderer simpleAO = nullptr;
+static OSPRenderer scivis   = nullptr;
+
+//! render with 'renderer', with or without batched AO rays
+static void setRenderer(OSPRenderer renderer, bool batching)
+{
+  ospSet1i(renderer, "aoBatching", batching);
+  ospCommit(renderer);
+  RenderFixture::renderer = renderer;
+}
+
+static OSPRenderer createRenderer(const char *type)
+{
+  OSPRenderer renderer = ospNewRenderer(type);
+  ospSetObject(renderer, "model", model);
+  ospSetObject(renderer, "camera", camera);
+  ospSet1i(renderer, "aoSamples", aoSamples);
+  ospSet1f(renderer, "aoWeight", 1.f);
+  ospSet1i(renderer, "backgroundEnabled", 0);
+  ospCommit(renderer);
+  return renderer;
+}
+
+static void createScene()
+{
+  // random spheres of varying size, so AO rays hit at all distances
+  std::vector<float> spheres;
+  srand(42);
+  for (int i = 0; i < numSpheres; i++) {
+    spheres.push_back(20.f * rand() / RAND_MAX - 10.f);
+    spheres.push_back(2.f * rand() / RAND_MAX);
+    spheres.push_back(20.f * rand() / RAND_MAX - 10.f);
+    spheres.push_back(0.02f + 0.2f * rand() / RAND_MAX);
+  }
+
+  model = ospNewModel();
+
+  OSPGeometry geometry = ospNewGeometry("spheres");
+  ospSetData(geometry, "spheres",
+             ospNewData(spheres.size(), OSP_FLOAT, spheres.data()));
+  ospSet1i(geometry, "bytes_per_sphere", 4 * sizeof(float));
+  ospSet1i(geometry, "offset_radius", 3 * sizeof(float));
+  ospCommit(geometry);
+  ospAddGeometry(model, geometry);
+
+  const float vertices[] = { -20.f, 0.f, -20.f,
+                              20.f, 0.f, -20.f,
+                              20.f, 0.f,  20.f,
+                             -20.f, 0.f,  20.f };
+  const int indices[] = { 0, 1, 2,   0, 2, 3 };
+  OSPGeometry ground = ospNewGeometry("triangles");
+  ospSetData(ground, "vertex", ospNewData(4, OSP_FLOAT3, vertices));
+  ospSetData(ground, "index", ospNewData(2, OSP_INT3, indices));
+  ospCommit(ground);
+  ospAddGeometry(model, ground);
+  ospCommit(model);
+
+  RenderFixture::imageSize = osp::vec2i{1024, 768};
+  camera = RenderFixture::createCamera(osp::vec3f{0.f, 6.f, -14.f},
+                                       osp::vec3f{0.f, -5.f, 14.f});
+
+  simpleAO = createRenderer("ao");
+  scivis = createRenderer("scivis");
+
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_RGBA8, OSP_FB_COLOR);
+}
+
+RENDER_BENCHMARK(ao,            5, 10, setRenderer(simpleAO, false))
+RENDER_BENCHMARK(aoBatched,     5, 10, setRenderer(simpleAO, true))
+RENDER_BENCHMARK(scivis,        5, 10, setRenderer(scivis, false))
+RENDER_BENCHMARK(scivisBatched, 5, 10, setRenderer(scivis, true))
+
+static void printRaysPerSecond(const char *name, OSPRenderer renderer,
+                               bool batching)
+{
+  setRenderer(renderer, batching);
+
+  // pixels with geometry are opaque, the background is transparent
+  const std::vector<unsigned char> image = RenderFixture::renderImage();
+  size_t hitPixels = 0;
+  for (size_t i = 3; i < image.size(); i += 4)
+    hitPixels += image[i] != 0;
+
+  const double seconds = RenderFixture::timeFrames(numFrames);
+  const osp::vec2i &size = RenderFixture::imageSize;
+  const double raysPerFrame =
+    double(size.x) * size.y + double(hitPixels) * aoSamples;
+  RenderFixture::printResult(name)
+    << numFrames * raysPerFrame / seconds * 1e-6 << " Mrays/s" << std::endl;
+}
+
+static void printResults()
+{
+  printRaysPerSecond("ao", simpleAO, false);
+  printRaysPerSecond("ao, batched", simpleAO, true);
+  printRaysPerSecond("scivis", scivis, false);
+  printRaysPerSecond("scivis, batched", scivis, true);
+}
+
+int main(int argc, const char *argv[])
+{
+  return RenderFixture::run(argc, argv, createScene, printResults);
+}
@@ -0,0 +1,135 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file AdaptiveSamplingBenchmark.cpp Compares the raycast volume
+    renderer's fixed rate sampling against adaptive sampling (see the
+    'adaptiveSampling' volume parameter) on a procedural volume with
+    a faint smooth background and one sharp, opaque shell, and prints
+    the RMS error of each mode against a densely sampled reference. */
+
+#include "RenderFixture.h"
+
+// std
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+static const int volumeSize = 256;
+
+static OSPVolume volume = nullptr;
+
+struct SamplingMode
+{
+  const char *name;
+  float samplingRate;
+  bool  adaptive;
+  float minSamplingRate;
+  float maxSamplingRate;
+};
+
+static const SamplingMode fixedRate1    = {"fixed rate 1",       1.f, false, 0.f, 0.f};
+static const SamplingMode fixedRate2    = {"fixed rate 2",       2.f, false, 0.f, 0.f};
+static const SamplingMode adaptive      = {"adaptive",           1.f, true, 0.25f, 2.f};
+static const SamplingMode adaptiveFast  = {"adaptive (fast)",    1.f, true, 0.125f, 1.f};
+static const SamplingMode reference     = {"reference (rate 8)", 8.f, false, 0.f, 0.f};
+
+static void setSamplingMode(const SamplingMode &mode)
+{
+  ospSet1f(volume, "samplingRate", mode.samplingRate);
+  ospSet1i(volume, "adaptiveSampling", mode.adaptive);
+  if (mode.adaptive) {
+    ospSet1f(volume, "adaptiveMinSamplingRate", mode.minSamplingRate);
+    ospSet1f(volume, "adaptiveMaxSamplingRate", mode.maxSamplingRate);
+  }
+  ospCommit(volume);
+}
+
+static void createScene()
+{
+  // radial field, with a thin shell of higher values at 60% radius
+  std::vector<float> voxels(size_t(volumeSize) * volumeSize * volumeSize);
+  const float center = 0.5f * (volumeSize - 1);
+  for (int z = 0; z < volumeSize; z++)
+    for (int y = 0; y < volumeSize; y++)
+      for (int x = 0; x < volumeSize; x++) {
+        const float dx = x - center, dy = y - center, dz = z - center;
+        const float r = std::sqrt(dx*dx + dy*dy + dz*dz) / center;
+        const float shell = std::fabs(r - 0.6f) < 0.02f ? 0.5f : 0.f;
+        voxels[(size_t(z) * volumeSize + y) * volumeSize + x]
+          = std::min(0.5f * r + shell, 1.f);
+      }
+
+  volume = ospNewVolume("block_bricked_volume");
+  ospSet3i(volume, "dimensions", volumeSize, volumeSize, volumeSize);
+  ospSetString(volume, "voxelType", "float");
+  ospSet2f(volume, "voxelRange", 0.f, 1.f);
+  ospSetRegion(volume, voxels.data(), osp::vec3i{0, 0, 0},
+               osp::vec3i{volumeSize, volumeSize, volumeSize});
+
+  // faint background, sharp opaque spike for the shell values
+  const int numOpacities = 256;
+  std::vector<float> opacities(numOpacities, 0.01f);
+  for (int i = 0; i < numOpacities; i++)
+    if (i >= int(0.78f * numOpacities) && i <= int(0.82f * numOpacities))
+      opacities[i] = 0.8f;
+
+  ospSetObject(volume, "transferFunction",
+               RenderFixture::createTransferFunction(opacities, 0.f, 1.f));
+  ospCommit(volume);
+
+  OSPModel model = ospNewModel();
+  ospAddVolume(model, volume);
+  ospCommit(model);
+
+  OSPCamera camera = RenderFixture::createCamera(
+    osp::vec3f{0.5f * volumeSize, 0.5f * volumeSize, -1.2f * volumeSize},
+    osp::vec3f{0.f, 0.f, 1.f});
+
+  OSPRenderer renderer = ospNewRenderer("raycast_volume_renderer");
+  ospSetObject(renderer, "model", model);
+  ospSetObject(renderer, "camera", camera);
+  ospCommit(renderer);
+
+  RenderFixture::renderer = renderer;
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_RGBA8, OSP_FB_COLOR);
+}
+
+RENDER_BENCHMARK(fixedRate1,   5, 20, setSamplingMode(fixedRate1))
+RENDER_BENCHMARK(fixedRate2,   5, 20, setSamplingMode(fixedRate2))
+RENDER_BENCHMARK(adaptive,     5, 20, setSamplingMode(adaptive))
+RENDER_BENCHMARK(adaptiveFast, 5, 20, setSamplingMode(adaptiveFast))
+
+//! image quality of each mode relative to the dense reference
+static void printResults()
+{
+  setSamplingMode(reference);
+  const std::vector<unsigned char> referenceImage =
+    RenderFixture::renderImage();
+  for (const SamplingMode *mode : {&fixedRate1, &fixedRate2,
+                                   &adaptive, &adaptiveFast}) {
+    setSamplingMode(*mode);
+    RenderFixture::printResult(mode->name)
+      << "RMS error vs. " << reference.name << ": "
+      << RenderFixture::rmsError(RenderFixture::renderImage(), referenceImage)
+      << std::endl;
+  }
+}
+
+int main(int argc, const char *argv[])
+{
+  return RenderFixture::run(argc, argv, createScene, printResults);
+}
@@ -0,0 +1,119 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file CommandStreamBenchmark.cpp Measures API command throughput
+    for parameter-heavy scenes, i.e., many objects that each get a
+    handful of ospSet*() calls followed by a commit.
+
+    Mostly interesting with the MPI device (run through mpirun with
+    --osp:mpi), where every API call becomes a command that has to be
+    shipped to the workers; with the local device it measures the
+    plain API/parameter overhead. */
+
+#include "hayai/hayai.hpp"
+
+// ospray
+#include "ospray/ospray.h"
+#include "ospcommon/common.h"
+
+#include <vector>
+
+using std::cout;
+using std::endl;
+
+// NOTE: number of API calls issued per object by setCameraParams()
+static const int commandsPerObject = 8;
+
+static void setCameraParams(OSPCamera camera, int i)
+{
+  ospSet3f(camera, "pos", i, 0.f, -10.f);
+  ospSet3f(camera, "dir", 0.f, 0.f, 1.f);
+  ospSet3f(camera, "up", 0.f, 1.f, 0.f);
+  ospSetf(camera, "aspect", 16.f/9.f);
+  ospSetf(camera, "fovy", 60.f);
+  ospSetf(camera, "apertureRadius", 0.f);
+  ospSetf(camera, "focusDistance", 1.f);
+  ospSet1i(camera, "id", i);
+}
+
+/*! set parameters on all given cameras, then commit only the last
+    one (a commit has to synchronize with the workers, so this is what
+    flushes all parameter changes in the MPI case) */
+static size_t runParamWorkload(const std::vector<OSPCamera> &cameras)
+{
+  for (size_t i = 0; i < cameras.size(); i++)
+    setCameraParams(cameras[i], i);
+  ospCommit(cameras.back());
+  return cameras.size() * commandsPerObject + 1;
+}
+
+/*! same as above, but commits every object */
+static size_t runParamAndCommitWorkload(const std::vector<OSPCamera> &cameras)
+{
+  for (size_t i = 0; i < cameras.size(); i++) {
+    setCameraParams(cameras[i], i);
+    ospCommit(cameras[i]);
+  }
+  return cameras.size() * (commandsPerObject + 1);
+}
+
+static std::vector<OSPCamera> cameras;
+
+BENCHMARK(CommandStream, setParams_1000objects, 10, 100)
+{
+  runParamWorkload(cameras);
+}
+
+BENCHMARK(CommandStream, setParamsAndCommit_1000objects, 10, 10)
+{
+  runParamAndCommitWorkload(cameras);
+}
+
+template<typename Workload>
+static void reportCommandsPerSecond(const char *name, Workload workload)
+{
+  const int numRuns = 10;
+  size_t numCommands = 0;
+  double t0 = ospcommon::getSysTime();
+  for (int i = 0; i < numRuns; i++)
+    numCommands += workload(cameras);
+  double t1 = ospcommon::getSysTime();
+
+  cout << "#osp:bench: " << name << ": " << numCommands << " commands in "
+       << (t1 - t0) << "s = " << (numCommands / (t1 - t0))
+       << " commands/s" << endl;
+}
+
+int main(int argc, const char *argv[])
+{
+  ospInit(&argc, argv);
+
+  for (int i = 0; i < 1000; i++)
+    cameras.push_back(ospNewCamera("perspective"));
+
+  hayai::ConsoleOutputter outputter;
+  hayai::Benchmarker::AddOutputter(outputter);
+
+  hayai::Benchmarker::RunAllTests();
+
+  reportCommandsPerSecond("setParams", runParamWorkload);
+  reportCommandsPerSecond("setParamsAndCommit", runParamAndCommitWorkload);
+
+  for (size_t i = 0; i < cameras.size(); i++)
+    ospRelease(cameras[i]);
+
+  return 0;
+}
@@ -0,0 +1,111 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file DistributionSamplingBenchmark.cpp Microbenchmark of
+    Distribution2D_sample() (binary search in the CDFs) against
+    Distribution2D_sampleAlias() (alias tables), on the distribution of
+    a 4K and an 8K HDRI environment map. Unlike
+    EnvironmentSamplingBenchmark it times the sampling alone, on a
+    single thread, and prints the throughput in Msamples/s. */
+
+#include "hayai/hayai.hpp"
+
+// ospray
+#include "ospray/ospray.h"
+#include "ospcommon/common.h"
+// std
+#include <algorithm>
+
+using std::cout;
+using std::endl;
+
+// exported by ospray/math/Distribution2D.ispc
+extern "C" {
+  void *Distribution2D_createBenchmark(int width, int height);
+  float Distribution2D_sampleBenchmark(void *distribution, int numSamples,
+                                       bool alias);
+  void Distribution2D_destroyBenchmark(void *distribution);
+}
+
+static const int numSamples = 1 << 22;
+
+static void *distribution4k = nullptr;
+static void *distribution8k = nullptr;
+
+// NOTE: keeps the compiler from dropping the sampling
+static volatile float pdfSum = 0.f;
+
+BENCHMARK(DistributionSampling, cdf4k, 5, 10)
+{
+  pdfSum = Distribution2D_sampleBenchmark(distribution4k, numSamples, false);
+}
+
+BENCHMARK(DistributionSampling, alias4k, 5, 10)
+{
+  pdfSum = Distribution2D_sampleBenchmark(distribution4k, numSamples, true);
+}
+
+BENCHMARK(DistributionSampling, cdf8k, 5, 10)
+{
+  pdfSum = Distribution2D_sampleBenchmark(distribution8k, numSamples, false);
+}
+
+BENCHMARK(DistributionSampling, alias8k, 5, 10)
+{
+  pdfSum = Distribution2D_sampleBenchmark(distribution8k, numSamples, true);
+}
+
+//! Msamples/s of the best of 'runs' runs
+static double samplesPerSecond(void *distribution, bool alias, int runs = 5)
+{
+  double best = 0.0;
+  for (int i = 0; i < runs; i++) {
+    const double start = ospcommon::getSysTime();
+    pdfSum = Distribution2D_sampleBenchmark(distribution, numSamples, alias);
+    const double seconds = ospcommon::getSysTime() - start;
+    best = std::max(best, numSamples / seconds * 1e-6);
+  }
+  return best;
+}
+
+int main(int argc, const char *argv[])
+{
+  ospInit(&argc, argv);
+
+  distribution4k = Distribution2D_createBenchmark(4096, 2048);
+  distribution8k = Distribution2D_createBenchmark(8192, 4096);
+
+  hayai::ConsoleOutputter outputter;
+  hayai::Benchmarker::AddOutputter(outputter);
+
+  hayai::Benchmarker::RunAllTests();
+
+  const struct { const char *name; void *distribution; } maps[] = {
+    {"4k", distribution4k},
+    {"8k", distribution8k}
+  };
+  for (const auto &map : maps) {
+    const double cdf = samplesPerSecond(map.distribution, false);
+    const double alias = samplesPerSecond(map.distribution, true);
+    cout << "#osp:bench: " << map.name << ": cdf " << cdf
+         << " Msamples/s, alias " << alias << " Msamples/s ("
+         << alias / cdf << "x)" << endl;
+  }
+
+  Distribution2D_destroyBenchmark(distribution4k);
+  Distribution2D_destroyBenchmark(distribution8k);
+  return 0;
+}
@@ -0,0 +1,125 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file EnvironmentSamplingBenchmark.cpp Measures importance sampling
+    of 4K and 8K HDRI environment maps, comparing the alias tables the
+    HDRI light samples with against searching the CDFs of its
+    distribution (see the 'aliasSampling' light parameter). The path
+    tracer renders a diffuse ground plane with a few spheres, lit only
+    by the environment, so sampling the map is a large share of the
+    frame time. DistributionSamplingBenchmark times the sampling
+    alone. */
+
+#include "RenderFixture.h"
+
+// std
+#include <vector>
+
+static OSPLight light4k = nullptr;
+static OSPLight light8k = nullptr;
+
+//! a sky gradient with a small, very bright sun
+static OSPLight createLight(OSPRenderer renderer, const osp::vec2i &size)
+{
+  std::vector<float> texels(3 * size_t(size.x) * size.y);
+  const float sunX = 0.3f * size.x;
+  const float sunY = 0.2f * size.y;
+  const float sunRadius = 0.005f * size.x;
+  for (int y = 0; y < size.y; y++)
+    for (int x = 0; x < size.x; x++) {
+      const float sky = 0.2f + 0.8f * (1.f - float(y) / size.y);
+      const float dx = x - sunX, dy = y - sunY;
+      const bool sun = dx*dx + dy*dy < sunRadius*sunRadius;
+      float *texel = &texels[3 * (size_t(y) * size.x + x)];
+      texel[0] = sun ? 5000.f : 0.5f * sky;
+      texel[1] = sun ? 4800.f : 0.7f * sky;
+      texel[2] = sun ? 4500.f : sky;
+    }
+
+  OSPTexture2D map = ospNewTexture2D(size, OSP_TEXTURE_RGB32F, texels.data());
+  OSPLight light = ospNewLight(renderer, "hdri");
+  ospSetObject(light, "map", map);
+  ospCommit(light);
+  return light;
+}
+
+//! light the scene with 'light' only, sampled via alias tables or CDFs
+static void setLight(OSPLight light, bool aliasSampling)
+{
+  ospSet1i(light, "aliasSampling", aliasSampling);
+  ospCommit(light);
+
+  OSPRenderer renderer = RenderFixture::renderer;
+  ospSetData(renderer, "lights", ospNewData(1, OSP_OBJECT, &light));
+  ospCommit(renderer);
+}
+
+static void createScene()
+{
+  OSPRenderer renderer = ospNewRenderer("pathtracer");
+  OSPModel model = ospNewModel();
+
+  OSPMaterial matte = ospNewMaterial(renderer, "Matte");
+  ospCommit(matte);
+
+  const float vertices[] = { -10.f, 0.f, -10.f,
+                              10.f, 0.f, -10.f,
+                              10.f, 0.f,  10.f,
+                             -10.f, 0.f,  10.f };
+  const int indices[] = { 0, 1, 2,   0, 2, 3 };
+  OSPGeometry ground = ospNewGeometry("triangles");
+  ospSetData(ground, "vertex", ospNewData(4, OSP_FLOAT3, vertices));
+  ospSetData(ground, "index", ospNewData(2, OSP_INT3, indices));
+  ospSetMaterial(ground, matte);
+  ospCommit(ground);
+  ospAddGeometry(model, ground);
+
+  const float spheres[] = { -2.f, 1.f, 0.f,   0.f, 1.f, 1.f,   2.f, 1.f, 0.f };
+  OSPGeometry occluders = ospNewGeometry("spheres");
+  ospSetData(occluders, "spheres", ospNewData(9, OSP_FLOAT, spheres));
+  ospSet1f(occluders, "radius", 1.f);
+  ospSet1i(occluders, "bytes_per_sphere", 3 * sizeof(float));
+  ospSetMaterial(occluders, matte);
+  ospCommit(occluders);
+  ospAddGeometry(model, occluders);
+  ospCommit(model);
+
+  OSPCamera camera = RenderFixture::createCamera(osp::vec3f{0.f, 4.f, -8.f},
+                                                 osp::vec3f{0.f, -3.f, 8.f});
+
+  ospSetObject(renderer, "model", model);
+  ospSetObject(renderer, "camera", camera);
+  ospSet1i(renderer, "maxDepth", 3);
+  ospSet1i(renderer, "spp", 4);
+  ospCommit(renderer);
+
+  light4k = createLight(renderer, osp::vec2i{4096, 2048});
+  light8k = createLight(renderer, osp::vec2i{8192, 4096});
+
+  RenderFixture::renderer = renderer;
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_SRGBA, OSP_FB_COLOR);
+}
+
+RENDER_BENCHMARK(cdf4k,   5, 10, setLight(light4k, false))
+RENDER_BENCHMARK(alias4k, 5, 10, setLight(light4k, true))
+RENDER_BENCHMARK(cdf8k,   5, 10, setLight(light8k, false))
+RENDER_BENCHMARK(alias8k, 5, 10, setLight(light8k, true))
+
+int main(int argc, const char *argv[])
+{
+  return RenderFixture::run(argc, argv, createScene);
+}
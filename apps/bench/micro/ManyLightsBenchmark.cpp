@@ -0,0 +1,124 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file ManyLightsBenchmark.cpp Measures how the path tracer scales
+    with the number of point lights, from 1 to 10k lights spread over a
+    ground plane with a few occluders.
+
+    By default each path vertex selects one light by power (see the
+    'lightSamples' renderer parameter); the "all" variants set
+    'lightSamples' to the number of lights, which costs as much as
+    sampling every light. */
+
+#include "RenderFixture.h"
+
+// std
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+//! light lists by size, the lights of a smaller list are a prefix
+static std::map<int, OSPData> lightData;
+static std::vector<OSPLight> lights;
+
+static void setLights(int numLights, int lightSamples)
+{
+  OSPRenderer renderer = RenderFixture::renderer;
+  if (lightData.find(numLights) == lightData.end())
+    lightData[numLights] = ospNewData(numLights, OSP_OBJECT, lights.data());
+  ospSetData(renderer, "lights", lightData[numLights]);
+  ospSet1i(renderer, "lightSamples", lightSamples);
+  ospCommit(renderer);
+}
+
+static void createScene()
+{
+  OSPRenderer renderer = ospNewRenderer("pathtracer");
+  OSPModel model = ospNewModel();
+
+  const float vertices[] = { -10.f, 0.f, -10.f,
+                              10.f, 0.f, -10.f,
+                              10.f, 0.f,  10.f,
+                             -10.f, 0.f,  10.f };
+  const int indices[] = { 0, 1, 2,   0, 2, 3 };
+  OSPGeometry ground = ospNewGeometry("triangles");
+  ospSetData(ground, "vertex", ospNewData(4, OSP_FLOAT3, vertices));
+  ospSetData(ground, "index", ospNewData(2, OSP_INT3, indices));
+  ospSetMaterial(ground, ospNewMaterial(renderer, "Matte"));
+  ospCommit(ground);
+  ospAddGeometry(model, ground);
+
+  std::vector<float> spheres;
+  for (int z = -4; z <= 4; z++)
+    for (int x = -4; x <= 4; x++) {
+      spheres.push_back(2.f * x);
+      spheres.push_back(0.5f);
+      spheres.push_back(2.f * z);
+    }
+  OSPGeometry occluders = ospNewGeometry("spheres");
+  ospSetData(occluders, "spheres",
+             ospNewData(spheres.size(), OSP_FLOAT, spheres.data()));
+  ospSet1f(occluders, "radius", 0.5f);
+  ospSet1i(occluders, "bytes_per_sphere", 3 * sizeof(float));
+  ospSetMaterial(occluders, ospNewMaterial(renderer, "Plastic"));
+  ospCommit(occluders);
+  ospAddGeometry(model, occluders);
+  ospCommit(model);
+
+  // small lights of random color and intensity just above the ground
+  srand(7);
+  for (int i = 0; i < 10000; i++) {
+    OSPLight light = ospNewLight(renderer, "point");
+    ospSet3f(light, "position", 20.f * rand() / RAND_MAX - 10.f,
+             0.2f + 1.5f * rand() / RAND_MAX, 20.f * rand() / RAND_MAX - 10.f);
+    ospSet3f(light, "color", float(rand()) / RAND_MAX,
+             float(rand()) / RAND_MAX, float(rand()) / RAND_MAX);
+    ospSet1f(light, "intensity", 2.f * rand() / RAND_MAX);
+    ospSet1f(light, "radius", 0.02f);
+    ospCommit(light);
+    lights.push_back(light);
+  }
+
+  OSPCamera camera = RenderFixture::createCamera(osp::vec3f{0.f, 8.f, -12.f},
+                                                 osp::vec3f{0.f, -8.f, 12.f});
+
+  ospSetObject(renderer, "model", model);
+  ospSetObject(renderer, "camera", camera);
+  ospSet1i(renderer, "maxDepth", 3);
+  ospCommit(renderer);
+
+  RenderFixture::renderer = renderer;
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_SRGBA, OSP_FB_COLOR);
+}
+
+#define MANY_LIGHTS_BENCHMARK(name, numLights, lightSamples)  \
+  RENDER_BENCHMARK(name, 3, 5, setLights(numLights, lightSamples))
+
+MANY_LIGHTS_BENCHMARK(lights1,     1,     1)
+MANY_LIGHTS_BENCHMARK(lights10,    10,    1)
+MANY_LIGHTS_BENCHMARK(lights100,   100,   1)
+MANY_LIGHTS_BENCHMARK(lights1k,    1000,  1)
+MANY_LIGHTS_BENCHMARK(lights10k,   10000, 1)
+
+MANY_LIGHTS_BENCHMARK(lights10all,  10,   10)
+MANY_LIGHTS_BENCHMARK(lights100all, 100,  100)
+MANY_LIGHTS_BENCHMARK(lights1kall,  1000, 1000)
+
+int main(int argc, const char *argv[])
+{
+  return RenderFixture::run(argc, argv, createScene);
+}
@@ -0,0 +1,210 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file OutOfCoreVolumeBenchmark.cpp Compares the sampling throughput
+    of the out_of_core_bricked_volume against a float
+    block_bricked_volume holding the same procedural volume, rendered
+    with the raycast volume renderer:
+
+    - blockBricked:  all voxels in memory
+    - outOfCore:     a memory budget holding all bricks, measures the
+                     cost of the brick lookups alone
+    - outOfCorePaged: a budget of a fifth of the bricks (but at least
+                     two bricks per thread), so bricks are paged in and
+                     evicted while rendering
+
+    The bricked file is written to the temporary directory first. */
+
+#include "RenderFixture.h"
+#include "volume/BrickedVolumeFile.h"
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const int volumeSize = 256;
+
+static const char *fileName = "/tmp/ospOutOfCoreBenchmark.osb";
+
+static OSPModel blockBrickedModel   = nullptr;
+static OSPModel outOfCoreModel      = nullptr;
+static OSPModel outOfCorePagedModel = nullptr;
+
+//! The same interference pattern as QuantizedVolumeBenchmark, in [-1, 1].
+static std::vector<float> createVoxels()
+{
+  std::vector<float> voxels(size_t(volumeSize) * volumeSize * volumeSize);
+  for (int z = 0; z < volumeSize; z++)
+    for (int y = 0; y < volumeSize; y++)
+      for (int x = 0; x < volumeSize; x++) {
+        const float fx = 0.05f * x, fy = 0.07f * y, fz = 0.03f * z;
+        voxels[(size_t(z) * volumeSize + y) * volumeSize + x]
+          = 0.5f * std::sin(fx + std::cos(fy)) * std::cos(fz)
+          + 0.5f * std::sin(3.f * fx * fy * 0.1f + fz);
+      }
+  return voxels;
+}
+
+//! Write the voxels in the layout of BrickedVolumeFile.h, like ospRaw2Bricks.
+static ospray::BrickedVolumeFileHeader
+writeBrickedFile(const std::vector<float> &voxels)
+{
+  using ospray::vec2f;
+  using ospray::vec3i;
+
+  ospray::BrickedVolumeFileHeader header;
+  header.init(OSP_FLOAT, sizeof(float), vec3i(volumeSize),
+              BRICKED_VOLUME_FILE_BRICK_WIDTH);
+
+  // cell value ranges, the pattern has no NaNs
+  std::vector<vec2f> cellRanges(header.numCells(), vec2f(99999.f, -99999.f));
+  for (int z = 0; z < volumeSize; z++)
+    for (int y = 0; y < volumeSize; y++)
+      for (int x = 0; x < volumeSize; x++) {
+        const float value = voxels[(size_t(z) * volumeSize + y) * volumeSize + x];
+        vec2f &range = cellRanges[x / BRICKED_VOLUME_FILE_CELL_WIDTH
+          + header.cellCount[0] * (y / BRICKED_VOLUME_FILE_CELL_WIDTH
+          + header.cellCount[1] * (z / BRICKED_VOLUME_FILE_CELL_WIDTH))];
+        range.x = std::min(range.x, value);
+        range.y = std::max(range.y, value);
+      }
+  header.voxelRange[0] = -1.f;
+  header.voxelRange[1] = 1.f;
+
+  FILE *file = fopen(fileName, "wb");
+  if (!file)
+    throw std::runtime_error(std::string("cannot write ") + fileName);
+
+  std::vector<char> prefix(header.brickDataOffset, 0);
+  memcpy(prefix.data(), &header, sizeof(header));
+  memcpy(prefix.data() + header.cellRangeOffset, cellRanges.data(),
+         cellRanges.size() * sizeof(vec2f));
+  fwrite(prefix.data(), prefix.size(), 1, file);
+
+  // bricks overlap by one voxel, voxels past the boundary repeat the last one
+  const int width = header.brickWidth;
+  std::vector<char> brick(header.brickBytes, 0);
+  float *brickVoxels = (float *)brick.data();
+  for (int bz = 0; bz < header.brickCount[2]; bz++)
+    for (int by = 0; by < header.brickCount[1]; by++)
+      for (int bx = 0; bx < header.brickCount[0]; bx++) {
+        const vec3i origin = vec3i(bx, by, bz) * (width - 1);
+        for (int z = 0; z < width; z++)
+          for (int y = 0; y < width; y++)
+            for (int x = 0; x < width; x++) {
+              const size_t srcX = std::min(origin.x + x, volumeSize - 1);
+              const size_t srcY = std::min(origin.y + y, volumeSize - 1);
+              const size_t srcZ = std::min(origin.z + z, volumeSize - 1);
+              brickVoxels[x + width * (y + size_t(width) * z)]
+                = voxels[(srcZ * volumeSize + srcY) * volumeSize + srcX];
+            }
+        fwrite(brick.data(), header.brickBytes, 1, file);
+      }
+
+  fclose(file);
+  return header;
+}
+
+static OSPModel createModel(OSPVolume volume,
+                            OSPTransferFunction transferFunction)
+{
+  ospSetObject(volume, "transferFunction", transferFunction);
+  ospSet1i(volume, "gradientShadingEnabled", 1);
+  ospCommit(volume);
+
+  OSPModel model = ospNewModel();
+  ospAddVolume(model, volume);
+  ospCommit(model);
+  return model;
+}
+
+static OSPModel createOutOfCoreModel(int memoryBudgetMB,
+                                     OSPTransferFunction transferFunction)
+{
+  OSPVolume volume = ospNewVolume("out_of_core_bricked_volume");
+  ospSetString(volume, "filename", fileName);
+  ospSet1i(volume, "memoryBudget", memoryBudgetMB);
+  return createModel(volume, transferFunction);
+}
+
+static void setModel(OSPModel model)
+{
+  ospSetObject(RenderFixture::renderer, "model", model);
+  ospCommit(RenderFixture::renderer);
+}
+
+static void createScene()
+{
+  const std::vector<float> voxels = createVoxels();
+  const ospray::BrickedVolumeFileHeader header = writeBrickedFile(voxels);
+
+  OSPTransferFunction transferFunction =
+    RenderFixture::createTransferFunction({0.f, 0.02f, 0.f, 0.3f, 0.f, 0.05f},
+                                          -1.f, 1.f);
+
+  OSPVolume volume = ospNewVolume("block_bricked_volume");
+  ospSet3i(volume, "dimensions", volumeSize, volumeSize, volumeSize);
+  ospSetString(volume, "voxelType", "float");
+  ospSet2f(volume, "voxelRange", -1.f, 1.f);
+  ospSetRegion(volume, (void *)voxels.data(), osp::vec3i{0, 0, 0},
+               osp::vec3i{volumeSize, volumeSize, volumeSize});
+  blockBrickedModel = createModel(volume, transferFunction);
+
+  const int fileMB = int((header.numBricks() * header.brickBytes) >> 20);
+  outOfCoreModel = createOutOfCoreModel(fileMB + 1, transferFunction);
+  outOfCorePagedModel = createOutOfCoreModel(std::max(fileMB / 5, 1),
+                                             transferFunction);
+
+  OSPCamera camera = RenderFixture::createCamera(
+    osp::vec3f{0.5f * volumeSize, 0.5f * volumeSize, -1.2f * volumeSize},
+    osp::vec3f{0.f, 0.f, 1.f});
+
+  RenderFixture::renderer = ospNewRenderer("raycast_volume_renderer");
+  ospSetObject(RenderFixture::renderer, "camera", camera);
+  setModel(blockBrickedModel);
+
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_RGBA8, OSP_FB_COLOR);
+}
+
+RENDER_BENCHMARK(blockBricked,   5, 20, setModel(blockBrickedModel))
+RENDER_BENCHMARK(outOfCore,      5, 20, setModel(outOfCoreModel))
+RENDER_BENCHMARK(outOfCorePaged, 5, 20, setModel(outOfCorePagedModel))
+
+static void printResults()
+{
+  // the out of core volume has to render the same image
+  setModel(blockBrickedModel);
+  const std::vector<unsigned char> referenceImage =
+    RenderFixture::renderImage();
+  setModel(outOfCorePagedModel);
+  RenderFixture::printResult("out_of_core_bricked_volume")
+    << "RMS error vs. block_bricked_volume: "
+    << RenderFixture::rmsError(RenderFixture::renderImage(), referenceImage)
+    << std::endl;
+
+  remove(fileName);
+}
+
+int main(int argc, const char *argv[])
+{
+  return RenderFixture::run(argc, argv, createScene, printResults);
+}
@@ -0,0 +1,155 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file QuantizedVolumeBenchmark.cpp Compares the sampling throughput
+    and voxel memory of the quantized_bricked_volume (8, 12 and 16 bits
+    per voxel) against a float block_bricked_volume, rendering the same
+    procedural volume with the raycast volume renderer. It also prints
+    the voxel memory of each volume and the RMS image error of the
+    quantized volumes against the float one. */
+
+#include "RenderFixture.h"
+
+// std
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+static const int volumeSize = 256;
+
+static OSPModel floatModel       = nullptr;
+static OSPModel quantized16Model = nullptr;
+static OSPModel quantized12Model = nullptr;
+static OSPModel quantized8Model  = nullptr;
+
+static OSPModel createModel(const char *volumeType, int bitsPerVoxel,
+                            const std::vector<float> &voxels,
+                            OSPTransferFunction transferFunction)
+{
+  OSPVolume volume = ospNewVolume(volumeType);
+  ospSet3i(volume, "dimensions", volumeSize, volumeSize, volumeSize);
+  ospSetString(volume, "voxelType", "float");
+  ospSet2f(volume, "voxelRange", -1.f, 1.f);
+  if (bitsPerVoxel)
+    ospSet1i(volume, "bitsPerVoxel", bitsPerVoxel);
+  ospSetRegion(volume, (void *)voxels.data(), osp::vec3i{0, 0, 0},
+               osp::vec3i{volumeSize, volumeSize, volumeSize});
+  ospSetObject(volume, "transferFunction", transferFunction);
+  ospSet1i(volume, "gradientShadingEnabled", 1);
+  ospCommit(volume);
+
+  OSPModel model = ospNewModel();
+  ospAddVolume(model, volume);
+  ospCommit(model);
+  return model;
+}
+
+static void setModel(OSPModel model)
+{
+  ospSetObject(RenderFixture::renderer, "model", model);
+  ospCommit(RenderFixture::renderer);
+}
+
+static void createScene()
+{
+  // smooth interference pattern with fine detail, in [-1, 1]
+  std::vector<float> voxels(size_t(volumeSize) * volumeSize * volumeSize);
+  for (int z = 0; z < volumeSize; z++)
+    for (int y = 0; y < volumeSize; y++)
+      for (int x = 0; x < volumeSize; x++) {
+        const float fx = 0.05f * x, fy = 0.07f * y, fz = 0.03f * z;
+        voxels[(size_t(z) * volumeSize + y) * volumeSize + x]
+          = 0.5f * std::sin(fx + std::cos(fy)) * std::cos(fz)
+          + 0.5f * std::sin(3.f * fx * fy * 0.1f + fz);
+      }
+
+  OSPTransferFunction transferFunction =
+    RenderFixture::createTransferFunction({0.f, 0.02f, 0.f, 0.3f, 0.f, 0.05f},
+                                          -1.f, 1.f);
+
+  floatModel = createModel("block_bricked_volume", 0, voxels,
+                           transferFunction);
+  quantized16Model = createModel("quantized_bricked_volume", 16, voxels,
+                                 transferFunction);
+  quantized12Model = createModel("quantized_bricked_volume", 12, voxels,
+                                 transferFunction);
+  quantized8Model = createModel("quantized_bricked_volume", 8, voxels,
+                                transferFunction);
+
+  OSPCamera camera = RenderFixture::createCamera(
+    osp::vec3f{0.5f * volumeSize, 0.5f * volumeSize, -1.2f * volumeSize},
+    osp::vec3f{0.f, 0.f, 1.f});
+
+  RenderFixture::renderer = ospNewRenderer("raycast_volume_renderer");
+  ospSetObject(RenderFixture::renderer, "camera", camera);
+  setModel(floatModel);
+
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_RGBA8, OSP_FB_COLOR);
+}
+
+//! Voxel memory of a block_bricked_volume, padded to 64^3 voxel blocks.
+static size_t blockBrickedBytes(size_t voxelSize)
+{
+  const size_t blocks = (volumeSize + 63) / 64;
+  return blocks * blocks * blocks * 64 * 64 * 64 * voxelSize;
+}
+
+//! Voxel memory of a quantized_bricked_volume, 8^3 voxel bricks plus the
+//! minimum and step of each brick.
+static size_t quantizedBytes(int bitsPerVoxel)
+{
+  const size_t bricks = (volumeSize + 7) / 8;
+  return bricks * bricks * bricks * (8 * 8 * 8 * bitsPerVoxel / 8 + 8);
+}
+
+RENDER_BENCHMARK(blockBrickedFloat, 5, 20, setModel(floatModel))
+RENDER_BENCHMARK(quantized16,       5, 20, setModel(quantized16Model))
+RENDER_BENCHMARK(quantized12,       5, 20, setModel(quantized12Model))
+RENDER_BENCHMARK(quantized8,        5, 20, setModel(quantized8Model))
+
+static void printResults()
+{
+  RenderFixture::printResult("voxel memory")
+    << "block_bricked_volume (float): "
+    << (blockBrickedBytes(sizeof(float)) >> 20) << " MB, "
+    << "quantized 16 bit: " << (quantizedBytes(16) >> 20) << " MB, "
+    << "quantized 12 bit: " << (quantizedBytes(12) >> 20) << " MB, "
+    << "quantized 8 bit: " << (quantizedBytes(8) >> 20) << " MB"
+    << std::endl;
+
+  // image quality of the quantized volumes relative to the float volume
+  setModel(floatModel);
+  const std::vector<unsigned char> referenceImage =
+    RenderFixture::renderImage();
+  const struct { const char *name; OSPModel model; } modes[] = {
+    {"quantized 16 bit", quantized16Model},
+    {"quantized 12 bit", quantized12Model},
+    {"quantized 8 bit",  quantized8Model}
+  };
+  for (const auto &mode : modes) {
+    setModel(mode.model);
+    RenderFixture::printResult(mode.name)
+      << "RMS error vs. float: "
+      << RenderFixture::rmsError(RenderFixture::renderImage(), referenceImage)
+      << std::endl;
+  }
+}
+
+int main(int argc, const char *argv[])
+{
+  return RenderFixture::run(argc, argv, createScene, printResults);
+}
@@ -0,0 +1,115 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "RenderFixture.h"
+
+// std
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+osp::vec2i     RenderFixture::imageSize = {512, 512};
+OSPRenderer    RenderFixture::renderer  = nullptr;
+OSPFrameBuffer RenderFixture::fb        = nullptr;
+
+void RenderFixture::renderFrame()
+{
+  ospRenderFrame(fb, renderer, OSP_FB_COLOR);
+}
+
+std::vector<unsigned char> RenderFixture::renderImage()
+{
+  renderFrame();
+
+  const unsigned char *pixels =
+    (const unsigned char *)ospMapFrameBuffer(fb, OSP_FB_COLOR);
+  std::vector<unsigned char> image(pixels,
+                                   pixels + 4 * imageSize.x * imageSize.y);
+  ospUnmapFrameBuffer(pixels, fb);
+  return image;
+}
+
+double RenderFixture::timeFrames(int numFrames, void (*render)())
+{
+  const auto begin = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < numFrames; i++)
+    render();
+  const auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double>(end - begin).count();
+}
+
+double RenderFixture::rmsError(const std::vector<unsigned char> &image,
+                               const std::vector<unsigned char> &reference)
+{
+  double sumSquares = 0.0;
+  for (size_t i = 0; i < image.size(); i++) {
+    const double d = (image[i] - reference[i]) / 255.0;
+    sumSquares += d * d;
+  }
+  return std::sqrt(sumSquares / image.size());
+}
+
+OSPCamera RenderFixture::createCamera(const osp::vec3f &pos,
+                                      const osp::vec3f &dir)
+{
+  OSPCamera camera = ospNewCamera("perspective");
+  ospSet1f(camera, "aspect", float(imageSize.x) / imageSize.y);
+  ospSet3f(camera, "pos", pos.x, pos.y, pos.z);
+  ospSet3f(camera, "dir", dir.x, dir.y, dir.z);
+  ospSet3f(camera, "up", 0.f, 1.f, 0.f);
+  ospCommit(camera);
+  return camera;
+}
+
+OSPTransferFunction
+RenderFixture::createTransferFunction(const std::vector<float> &opacities,
+                                      float minValue, float maxValue)
+{
+  const float colors[] = { 0.f, 0.f, 1.f,   0.f, 1.f, 0.f,   1.f, 0.f, 0.f };
+
+  OSPTransferFunction transferFunction =
+    ospNewTransferFunction("piecewise_linear");
+  OSPData colorData = ospNewData(3, OSP_FLOAT3, colors);
+  OSPData opacityData = ospNewData(opacities.size(), OSP_FLOAT,
+                                   opacities.data());
+  ospSetData(transferFunction, "colors", colorData);
+  ospSetData(transferFunction, "opacities", opacityData);
+  ospSet2f(transferFunction, "valueRange", minValue, maxValue);
+  ospCommit(transferFunction);
+  return transferFunction;
+}
+
+int RenderFixture::run(int argc, const char *argv[],
+                       void (*createScene)(), void (*printResults)())
+{
+  ospInit(&argc, argv);
+  createScene();
+
+  hayai::ConsoleOutputter outputter;
+  hayai::Benchmarker::AddOutputter(outputter);
+
+  hayai::Benchmarker::RunAllTests();
+
+  if (printResults)
+    printResults();
+
+  return 0;
+}
+
+std::ostream &RenderFixture::printResult(const char *name)
+{
+  return std::cout << "#osp:bench: " << name << ": ";
+}
@@ -0,0 +1,80 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+/*! \file RenderFixture.h Shared setup of the rendering microbenchmarks:
+    each of them builds its scene once through the public API, then
+    renders the same frame buffer with one renderer while switching
+    parameters between benchmarks. */
+
+#include "hayai/hayai.hpp"
+
+// ospray
+#include "ospray/ospray.h"
+// std
+#include <ostream>
+#include <vector>
+
+struct RenderFixture : public hayai::Fixture
+{
+  //! render a frame with the current settings
+  static void renderFrame();
+
+  //! render a frame and return a copy of its (8 bit per channel) pixels
+  static std::vector<unsigned char> renderImage();
+
+  //! seconds it takes to render 'numFrames' frames with 'render'
+  static double timeFrames(int numFrames, void (*render)() = renderFrame);
+
+  //! RMS error of 'image' against 'reference', in [0, 1]
+  static double rmsError(const std::vector<unsigned char> &image,
+                         const std::vector<unsigned char> &reference);
+
+  //! a perspective camera at 'pos' looking along 'dir', matching imageSize
+  static OSPCamera createCamera(const osp::vec3f &pos, const osp::vec3f &dir);
+
+  //! a piecewise linear blue-green-red transfer function
+  static OSPTransferFunction
+  createTransferFunction(const std::vector<float> &opacities,
+                         float minValue, float maxValue);
+
+  /*! create the scene via 'createScene', run all registered benchmarks,
+      then call 'printResults' (if given) for additional measurements */
+  static int run(int argc, const char *argv[],
+                 void (*createScene)(), void (*printResults)() = nullptr);
+
+  //! start a "#osp:bench: <name>: " line of the additional measurements
+  static std::ostream &printResult(const char *name);
+
+  // Fixture data, set up by createScene //
+
+  static osp::vec2i     imageSize;
+  static OSPRenderer    renderer;
+  static OSPFrameBuffer fb;
+};
+
+/*! a benchmark 'name' rendering frames, with 'setUp' run before each
+    run of 'iterations' frames */
+#define RENDER_BENCHMARK(name, runs, iterations, setUp)         \
+  struct name##Fixture : public RenderFixture                   \
+  {                                                             \
+    void SetUp() override { setUp; }                            \
+  };                                                            \
+  BENCHMARK_F(name##Fixture, name, runs, iterations)            \
+  {                                                             \
+    renderFrame();                                              \
+  }
@@ -0,0 +1,116 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file TaskingBenchmark.cpp Microbenchmark of the per-node tasking
+    system, using the same fork-join structure (and job granularity)
+    as LocalTiledLoadBalancer::renderFrame() + Renderer_renderTile().
+
+    The tasking backend is a compile-time choice, so build OSPRay once
+    per OSPRAY_TASKING_SYSTEM (TBB, OpenMP, Internal) and compare the
+    numbers this reports. */
+
+#include "hayai/hayai.hpp"
+
+// ospray
+#include "ospray/ospray.h"
+#include "common/OSPCommon.h"
+#include "common/tasking/parallel_for.h"
+
+using std::cout;
+using std::endl;
+
+static const char *taskingSystemName()
+{
+#if defined(OSPRAY_TASKING_TBB)
+  return "TBB";
+#elif defined(OSPRAY_TASKING_CILK)
+  return "Cilk";
+#elif defined(OSPRAY_TASKING_OMP)
+  return "OpenMP";
+#elif defined(OSPRAY_TASKING_INTERNAL)
+  return "Internal";
+#else
+  return "Debug";
+#endif
+}
+
+// NOTE: roughly the cost of shading one pixel with a cheap renderer
+static inline float fakePixelWork(int pixelID)
+{
+  float v = pixelID;
+  for (int i = 0; i < 64; ++i)
+    v = v * 0.999f + 0.5f;
+  return v;
+}
+
+static void renderFakeFrame(int width, int height, size_t numJobs)
+{
+  const int numTiles_x = (width  + TILE_SIZE - 1) / TILE_SIZE;
+  const int numTiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+  const int pixelsPerJob = (TILE_SIZE * TILE_SIZE) / numJobs;
+
+  ospray::parallel_for(numTiles_x * numTiles_y, [&](int taskIndex) {
+    float __aligned(64) tile[TILE_SIZE * TILE_SIZE];
+
+    ospray::parallel_for(numJobs, [&](int jobID) {
+      const int begin = jobID * pixelsPerJob;
+      for (int i = begin; i < begin + pixelsPerJob; ++i)
+        tile[i] = fakePixelWork(taskIndex * TILE_SIZE * TILE_SIZE + i);
+    });
+  });
+}
+
+// tile jobs as scheduled with spp>=1 (one job per RENDERTILE_PIXELS_PER_JOB)
+BENCHMARK(Tasking, tileJobs_1024x1024, 10, 100)
+{
+  renderFakeFrame(1024, 1024, (TILE_SIZE*TILE_SIZE)/RENDERTILE_PIXELS_PER_JOB);
+}
+
+BENCHMARK(Tasking, tileJobs_3840x2160, 10, 50)
+{
+  renderFakeFrame(3840, 2160, (TILE_SIZE*TILE_SIZE)/RENDERTILE_PIXELS_PER_JOB);
+}
+
+// one job per tile, i.e., only the outer parallel_for does any scheduling
+BENCHMARK(Tasking, wholeTiles_1024x1024, 10, 100)
+{
+  renderFakeFrame(1024, 1024, 1);
+}
+
+// empty jobs, measures pure scheduling overhead
+BENCHMARK(Tasking, emptyJobs, 10, 100)
+{
+  ospray::parallel_for(256, [&](int) {
+    ospray::parallel_for((TILE_SIZE*TILE_SIZE)/RENDERTILE_PIXELS_PER_JOB,
+                         [&](int) {});
+  });
+}
+
+int main(int argc, const char *argv[])
+{
+  // NOTE: initializes the tasking system (incl. --osp:numthreads)
+  ospInit(&argc, argv);
+
+  cout << "#osp:bench: tasking system: " << taskingSystemName()
+       << ", TILE_SIZE " << TILE_SIZE
+       << ", RENDERTILE_PIXELS_PER_JOB " << RENDERTILE_PIXELS_PER_JOB << endl;
+
+  hayai::ConsoleOutputter outputter;
+  hayai::Benchmarker::AddOutputter(outputter);
+
+  hayai::Benchmarker::RunAllTests();
+  return 0;
+}
@@ -0,0 +1,196 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+/*! \file TimeSeriesVolumeBenchmark.cpp Playback frame rate of the
+    time_series_volume. Each iteration advances the time, commits the
+    volume and renders a frame, so the measured time includes swapping
+    in the next timestep:
+
+    - noPrefetch:   a window of one step, every step is loaded on demand
+    - prefetch:     a window of three steps loaded in the background
+    - interpolated: quarter step increments blending adjacent steps
+
+    The timesteps are written as raw files to the temporary directory
+    first. */
+
+#include "RenderFixture.h"
+
+// std
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static const int volumeSize    = 192;
+static const int timeStepCount = 8;
+
+static const char *fileNamePattern = "/tmp/ospTimeSeriesBenchmark_%02d.raw";
+
+static OSPTransferFunction transferFunction = nullptr;
+
+//! Write the timesteps: a blob travelling through a noisy background.
+static void writeTimeSteps()
+{
+  std::vector<float> voxels(size_t(volumeSize) * volumeSize * volumeSize);
+  for (int t = 0; t < timeStepCount; t++) {
+    const float cx = volumeSize * (0.25f + 0.5f * t / (timeStepCount - 1));
+    for (int z = 0; z < volumeSize; z++)
+      for (int y = 0; y < volumeSize; y++)
+        for (int x = 0; x < volumeSize; x++) {
+          const float dx = x - cx, dy = y - 0.5f * volumeSize,
+                      dz = z - 0.5f * volumeSize;
+          const float r = std::sqrt(dx * dx + dy * dy + dz * dz);
+          voxels[(size_t(z) * volumeSize + y) * volumeSize + x]
+            = std::exp(-r * r / (0.02f * volumeSize * volumeSize))
+            + 0.1f * std::sin(0.1f * x + 0.3f * t) * std::cos(0.13f * y);
+        }
+
+    char fileName[256];
+    snprintf(fileName, sizeof(fileName), fileNamePattern, t);
+    FILE *file = fopen(fileName, "wb");
+    if (!file)
+      throw std::runtime_error(std::string("cannot write ") + fileName);
+    fwrite(voxels.data(), sizeof(float), voxels.size(), file);
+    fclose(file);
+  }
+}
+
+struct Playback
+{
+  OSPVolume volume;
+  OSPModel model;
+  float time;
+  float timeIncrement;
+
+  Playback(int windowSize, bool interpolation)
+    : time(0.f), timeIncrement(interpolation ? 0.25f : 1.f)
+  {
+    volume = ospNewVolume("time_series_volume");
+    ospSetString(volume, "filename", fileNamePattern);
+    ospSet1i(volume, "timeStepCount", timeStepCount);
+    ospSet3i(volume, "dimensions", volumeSize, volumeSize, volumeSize);
+    ospSetString(volume, "voxelType", "float");
+    ospSet2f(volume, "voxelRange", -0.1f, 1.1f);
+    ospSet1i(volume, "windowSize", windowSize);
+    ospSet1i(volume, "interpolation", interpolation);
+    ospSetObject(volume, "transferFunction", transferFunction);
+    ospSet1f(volume, "timeStep", time);
+    ospCommit(volume);
+
+    model = ospNewModel();
+    ospAddVolume(model, volume);
+    ospCommit(model);
+  }
+
+  //! Render this series with the fixture's renderer.
+  void select()
+  {
+    ospSetObject(RenderFixture::renderer, "model", model);
+    ospCommit(RenderFixture::renderer);
+  }
+
+  //! Advance to the next frame (wrapping around) and render it.
+  void renderNextFrame()
+  {
+    time += timeIncrement;
+    if (time > timeStepCount - 1)
+      time = 0.f;
+    ospSet1f(volume, "timeStep", time);
+    ospCommit(volume);
+    RenderFixture::renderFrame();
+  }
+};
+
+static Playback *noPrefetch   = nullptr;
+static Playback *prefetch     = nullptr;
+static Playback *interpolated = nullptr;
+
+static void createScene()
+{
+  writeTimeSteps();
+
+  transferFunction =
+    RenderFixture::createTransferFunction({0.f, 0.f, 0.05f, 0.2f, 0.5f},
+                                          -0.1f, 1.1f);
+
+  OSPCamera camera = RenderFixture::createCamera(
+    osp::vec3f{0.5f * volumeSize, 0.5f * volumeSize, -1.2f * volumeSize},
+    osp::vec3f{0.f, 0.f, 1.f});
+
+  RenderFixture::renderer = ospNewRenderer("raycast_volume_renderer");
+  ospSetObject(RenderFixture::renderer, "camera", camera);
+  ospCommit(RenderFixture::renderer);
+
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_RGBA8, OSP_FB_COLOR);
+
+  noPrefetch   = new Playback(1, false);
+  prefetch     = new Playback(3, false);
+  interpolated = new Playback(3, true);
+}
+
+#define PLAYBACK_BENCHMARK(name)                                \
+  struct name##Fixture : public RenderFixture                   \
+  {                                                             \
+    void SetUp() override { name->select(); }                   \
+  };                                                            \
+  BENCHMARK_F(name##Fixture, name, 2, 2 * timeStepCount)        \
+  {                                                             \
+    name->renderNextFrame();                                    \
+  }
+
+PLAYBACK_BENCHMARK(noPrefetch)
+PLAYBACK_BENCHMARK(prefetch)
+PLAYBACK_BENCHMARK(interpolated)
+
+static Playback *current = nullptr;
+
+static void renderNextFrame()
+{
+  current->renderNextFrame();
+}
+
+//! playback frame rate over a full pass through the series
+static void printResults()
+{
+  const struct { const char *name; Playback *playback; } modes[] = {
+    {"noPrefetch", noPrefetch},
+    {"prefetch", prefetch},
+    {"interpolated", interpolated}
+  };
+  for (const auto &mode : modes) {
+    current = mode.playback;
+    current->select();
+    const int frames = int((timeStepCount - 1) / current->timeIncrement);
+    const double seconds = RenderFixture::timeFrames(frames, renderNextFrame);
+    RenderFixture::printResult(mode.name)
+      << frames / seconds << " fps playback" << std::endl;
+  }
+
+  for (int t = 0; t < timeStepCount; t++) {
+    char fileName[256];
+    snprintf(fileName, sizeof(fileName), fileNamePattern, t);
+    remove(fileName);
+  }
+}
+
+int main(int argc, const char *argv[])
+{
+  return RenderFixture::run(argc, argv, createScene, printResults);
+}
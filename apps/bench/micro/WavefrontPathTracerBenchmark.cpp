@@ -0,0 +1,142 @@
+// ======================================================================== //
+// Copyright 2016 Intel Corporation                                         //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file WavefrontPathTracerBenchmark.cpp Compares the path tracer's
+    megakernel with its wavefront mode (see the 'wavefront' renderer
+    parameter) on a scene of spheres with mixed materials.
+
+    Afterwards it renders some frames of each mode with the renderer's
+    'stats' parameter set: the renderer prints the rays traced and the
+    SIMD efficiency of material shading of every frame, the benchmark
+    prints the frame rate, which together give the rays per second.
+    The renderer prints its stats only when verbose, so the benchmark
+    runs with --osp:verbose. */
+
+#include "RenderFixture.h"
+
+// std
+#include <iostream>
+#include <vector>
+
+static const int gridSize = 8;
+static const int numFrames = 10;
+
+static void setWavefront(bool wavefront)
+{
+  ospSet1i(RenderFixture::renderer, "wavefront", wavefront);
+  ospCommit(RenderFixture::renderer);
+}
+
+static OSPMaterial createMaterial(OSPRenderer renderer, int i)
+{
+  static const char *types[] = {"Matte", "Plastic", "Metal", "Glass", "Velvet"};
+  OSPMaterial material = ospNewMaterial(renderer, types[i % 5]);
+  const float shade = 0.3f + 0.7f * (i % 7) / 6.f;
+  ospSet3f(material, "reflectance", shade, 0.5f, 1.f - shade);
+  ospSet3f(material, "pigmentColor", shade, 0.5f, 1.f - shade);
+  ospSet3f(material, "color", shade, 0.5f, 1.f - shade);
+  ospCommit(material);
+  return material;
+}
+
+static void createScene()
+{
+  OSPRenderer renderer = ospNewRenderer("pathtracer");
+  OSPModel model = ospNewModel();
+
+  // a grid of spheres, cycling through the materials
+  for (int i = 0; i < gridSize * gridSize; i++) {
+    const float sphere[] = { float(i % gridSize), 0.4f, float(i / gridSize) };
+    OSPData data = ospNewData(3, OSP_FLOAT, sphere);
+    OSPGeometry spheres = ospNewGeometry("spheres");
+    ospSetData(spheres, "spheres", data);
+    ospSet1f(spheres, "radius", 0.4f);
+    ospSet1i(spheres, "bytes_per_sphere", 3 * sizeof(float));
+    ospSetMaterial(spheres, createMaterial(renderer, i));
+    ospCommit(spheres);
+    ospAddGeometry(model, spheres);
+  }
+
+  // ground plane
+  const float extent = 2.f * gridSize;
+  const float vertices[] = { -extent, 0.f, -extent,
+                              extent, 0.f, -extent,
+                              extent, 0.f,  extent,
+                             -extent, 0.f,  extent };
+  const int indices[] = { 0, 1, 2,   0, 2, 3 };
+  OSPGeometry ground = ospNewGeometry("triangles");
+  ospSetData(ground, "vertex", ospNewData(4, OSP_FLOAT3, vertices));
+  ospSetData(ground, "index", ospNewData(2, OSP_INT3, indices));
+  ospSetMaterial(ground, createMaterial(renderer, 0));
+  ospCommit(ground);
+  ospAddGeometry(model, ground);
+  ospCommit(model);
+
+  OSPLight sun = ospNewLight(renderer, "distant");
+  ospSet3f(sun, "direction", -1.f, -2.f, 0.5f);
+  ospSet1f(sun, "angularDiameter", 0.53f);
+  ospSet1f(sun, "intensity", 3.f);
+  ospCommit(sun);
+  OSPLight sky = ospNewLight(renderer, "ambient");
+  ospSet3f(sky, "color", 0.6f, 0.7f, 1.f);
+  ospCommit(sky);
+  OSPLight lights[] = { sun, sky };
+
+  OSPCamera camera = RenderFixture::createCamera(
+    osp::vec3f{0.5f * gridSize, 0.6f * gridSize, -0.6f * gridSize},
+    osp::vec3f{0.f, -0.6f, 1.f});
+
+  ospSetObject(renderer, "model", model);
+  ospSetObject(renderer, "camera", camera);
+  ospSetData(renderer, "lights", ospNewData(2, OSP_OBJECT, lights));
+  ospSet1i(renderer, "maxDepth", 5);
+  ospCommit(renderer);
+
+  RenderFixture::renderer = renderer;
+  RenderFixture::fb = ospNewFrameBuffer(RenderFixture::imageSize,
+                                        OSP_FB_SRGBA, OSP_FB_COLOR);
+}
+
+RENDER_BENCHMARK(megakernel, 5, 10, setWavefront(false))
+RENDER_BENCHMARK(wavefront,  5, 10, setWavefront(true))
+
+static void printFrameRate(const char *name, bool wavefront)
+{
+  ospSet1i(RenderFixture::renderer, "stats", 1);
+  setWavefront(wavefront);
+
+  const double seconds = RenderFixture::timeFrames(numFrames);
+  RenderFixture::printResult(name)
+    << numFrames / seconds << " fps" << std::endl;
+
+  ospSet1i(RenderFixture::renderer, "stats", 0);
+  ospCommit(RenderFixture::renderer);
+}
+
+static void printResults()
+{
+  printFrameRate("megakernel", false);
+  printFrameRate("wavefront", true);
+}
+
+int main(int argc, const char *argv[])
+{
+  // before the given arguments, so that e.g. --osp:vv still applies
+  std::vector<const char *> args(argv, argv + argc);
+  args.insert(args.begin() + 1, "--osp:verbose");
+  return RenderFixture::run(args.size(), args.data(), createScene,
+                            printResults);
+}
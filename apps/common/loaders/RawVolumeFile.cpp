@@ -18,6 +18,8 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <algorithm>
+#include <thread>
 
 #include "common/FileName.h"
 
@@ -125,45 +127,71 @@ ospcommon::vec2f voxelRange(+std::numeric_limits<float>::infinity(),
 
   if (!useSubvolume) {
 
-    size_t numSlicesPerSetRegion = 4;
-
     // Voxel count.
     size_t voxelCount = volumeDimensions.x * volumeDimensions.y;
 
-    // Allocate memory for a single slice through the volume.
-    unsigned char *voxelData =
-        new unsigned char[numSlicesPerSetRegion * voxelCount * voxelSize];
+    // We copy data into the volume by slabs of slices, sized so that a slab
+    // is large enough to amortize the per-call overhead of ospSetRegion()
+    // while memory use stays bounded.
+    const size_t maxSlabSize = 64*1024*1024;
+    const size_t numSlicesPerSetRegion =
+        std::max(size_t(1), maxSlabSize / (voxelCount * voxelSize));
+
+    // Two slab buffers: the next slab gets read from the file while the
+    // current one is copied into the volume.
+    unsigned char *voxelData[2] = {
+      new unsigned char[numSlicesPerSetRegion * voxelCount * voxelSize],
+      new unsigned char[numSlicesPerSetRegion * voxelCount * voxelSize]
+    };
+
+    auto readSlab = [&](unsigned char *slab, size_t z) {
+      size_t slicesToRead = std::min(numSlicesPerSetRegion,
+                                     volumeDimensions.z - z);
+      return fread(slab, voxelSize, slicesToRead * voxelCount, file);
+    };
 
-    // We copy data into the volume by the slice in case memory is limited.
-    for (size_t z = 0 ; z < volumeDimensions.z ; z += numSlicesPerSetRegion) {
+    size_t voxelsRead = readSlab(voxelData[0], 0);
+
+    for (size_t z = 0, slab = 0 ; z < volumeDimensions.z ;
+         z += numSlicesPerSetRegion, slab ^= 1) {
 
-      // Copy voxel data into the buffer.
       size_t slicesToRead = std::min(numSlicesPerSetRegion,
                                      volumeDimensions.z - z);
 
-      size_t voxelsRead = fread(voxelData,
-                                voxelSize,
-                                slicesToRead * voxelCount,
-                                file);
-
       // The end of the file may have been reached unexpectedly.
       exitOnCondition(voxelsRead != slicesToRead*voxelCount,
                       "end of volume file reached before read completed");
 
+      // Start reading the next slab.
+      size_t nextVoxelsRead = 0;
+      std::thread reader;
+      if (z + slicesToRead < volumeDimensions.z) {
+        reader = std::thread([&]() {
+          nextVoxelsRead = readSlab(voxelData[slab ^ 1], z + slicesToRead);
+        });
+      }
+
+      // Join the reader also when an error below unwinds the stack, as
+      // destroying a joinable std::thread would terminate the program.
+      struct JoinGuard {
+        std::thread &thread;
+        ~JoinGuard() { if (thread.joinable()) thread.join(); }
+      } joinReader{reader};
+
       if (strcmp(voxelType, "uchar") == 0) {
         extendVoxelRange(voxelRange,
-                         (unsigned char *)voxelData,
-                         volumeDimensions.x*volumeDimensions.y);
+                         (unsigned char *)voxelData[slab],
+                         slicesToRead*voxelCount);
       }
       else if (strcmp(voxelType, "float") == 0) {
         extendVoxelRange(voxelRange,
-                         (float *)voxelData,
-                         volumeDimensions.x*volumeDimensions.y);
+                         (float *)voxelData[slab],
+                         slicesToRead*voxelCount);
       }
       else if (strcmp(voxelType, "double") == 0) {
         extendVoxelRange(voxelRange,
-                         (double *)voxelData,
-                         volumeDimensions.x*volumeDimensions.y);
+                         (double *)voxelData[slab],
+                         slicesToRead*voxelCount);
       }
       else {
         exitOnCondition(true, "unsupported voxel type");
@@ -175,17 +203,22 @@ ospcommon::vec2f voxelRange(+std::numeric_limits<float>::infinity(),
                               slicesToRead);
       // Copy the voxels into the volume.
       ospSetRegion(volume,
-                   voxelData,
+                   voxelData[slab],
                    (osp::vec3i&)region_lo,
                    (osp::vec3i&)region_sz);
 
+      if (reader.joinable())
+        reader.join();
+      voxelsRead = nextVoxelsRead;
+
       // std::cerr << "volume load: "
       //           << float(z) / float(volumeDimensions.z) * 100. << " %"
       //           << std::endl;
     }
 
     // Clean up.
-    delete [] voxelData;
+    delete [] voxelData[0];
+    delete [] voxelData[1];
 
   } else {
 
@@ -36,6 +36,7 @@ public:
   Light    newLight(const std::string &type);
 
   float renderFrame(const FrameBuffer &fb, uint32_t channels);
+  OSPFuture renderFrameAsync(const FrameBuffer &fb, uint32_t channels);
 };
 
 // Inlined function definitions ///////////////////////////////////////////////
@@ -81,6 +82,12 @@ inline float Renderer::renderFrame(const FrameBuffer &fb, uint32_t channels)
   return ospRenderFrame(fb.handle(), handle(), channels);
 }
 
+inline OSPFuture Renderer::renderFrameAsync(const FrameBuffer &fb,
+                                            uint32_t channels)
+{
+  return ospRenderFrameAsync(fb.handle(), handle(), channels);
+}
+
 
 }// namespace cpp
 }// namespace ospray
@@ -0,0 +1,282 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+// Converts a .raw volume (as read by RawVolumeFile) into the bricked file
+// format paged in by the out_of_core_bricked_volume, see
+// ospray/volume/BrickedVolumeFile.h.
+
+#include "ospray/volume/BrickedVolumeFile.h"
+
+// std
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+// stdlib, for mmap
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+#include <fcntl.h>
+
+// O_LARGEFILE is a GNU extension.
+#ifdef __APPLE__
+#define  O_LARGEFILE  0
+#endif
+
+using std::cout;
+using std::cerr;
+using std::endl;
+using namespace ospray;
+
+void printUsageAndExit()
+{
+  cout << "Usage: ospRaw2Bricks [options] input.raw output.osb" << endl;
+  cout << endl;
+  cout << "Options:" << endl;
+  cout << "    -dimensions | -d <x> <y> <z> --> volume size in voxels"
+       << " (required)" << endl;
+  cout << "    -voxelType  | -t <type>      --> uchar, ushort, float or"
+       << " double (default: uchar)" << endl;
+  cout << "    -offset <bytes>              --> header bytes to skip in the"
+       << " input (default: 0)" << endl;
+  cout << "    -brickWidth <voxels>         --> brick width including the"
+       << " ghost layer (default: " << BRICKED_VOLUME_FILE_BRICK_WIDTH << ")"
+       << endl;
+  exit(1);
+}
+
+//! Map a file read-only, returns nullptr on failure.
+const char *mapFile(const std::string &fileName, size_t &fileSize)
+{
+#ifdef _WIN32
+  HANDLE fileHandle = CreateFile(fileName.c_str(), GENERIC_READ,
+                                 FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+    return nullptr;
+  LARGE_INTEGER size;
+  GetFileSizeEx(fileHandle, &size);
+  fileSize = size.QuadPart;
+  HANDLE fileMappingHandle = CreateFileMapping(fileHandle, nullptr,
+                                               PAGE_READONLY, 0, 0, nullptr);
+  if (fileMappingHandle == nullptr)
+    return nullptr;
+  return (const char *)MapViewOfFile(fileMappingHandle, FILE_MAP_READ, 0, 0, 0);
+#else
+  int fd = ::open(fileName.c_str(), O_LARGEFILE | O_RDONLY);
+  if (fd == -1)
+    return nullptr;
+  struct stat fileStat;
+  fstat(fd, &fileStat);
+  fileSize = fileStat.st_size;
+  void *mapping = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  return (mapping == MAP_FAILED) ? nullptr : (const char *)mapping;
+#endif
+}
+
+//! Compute the value range of every accelerator cell and of the volume.
+template<typename T>
+void computeRanges(const T *voxels,
+                   BrickedVolumeFileHeader &header,
+                   std::vector<vec2f> &cellRanges)
+{
+  const vec3i dims(header.dimensions[0], header.dimensions[1],
+                   header.dimensions[2]);
+  const vec3i cellCount(header.cellCount[0], header.cellCount[1],
+                        header.cellCount[2]);
+  cellRanges.assign(header.numCells(), vec2f(99999.0f, -99999.0f));
+  vec2f voxelRange(+INFINITY, -INFINITY);
+
+  // Same sentinel and NaN handling as GridAccelerator_encodeBrickCell().
+  for (int z = 0; z < dims.z; z++) {
+    for (int y = 0; y < dims.y; y++) {
+      const T *row = voxels + dims.x * (y + (size_t)dims.y * z);
+      vec2f *cellRow = &cellRanges[cellCount.x * (y / BRICKED_VOLUME_FILE_CELL_WIDTH
+          + (size_t)cellCount.y * (z / BRICKED_VOLUME_FILE_CELL_WIDTH))];
+      for (int x = 0; x < dims.x; x++) {
+        const float value = row[x];
+        if (std::isnan(value))
+          continue;
+        vec2f &cellRange = cellRow[x / BRICKED_VOLUME_FILE_CELL_WIDTH];
+        cellRange.x = std::min(cellRange.x, value);
+        cellRange.y = std::max(cellRange.y, value);
+        voxelRange.x = std::min(voxelRange.x, value);
+        voxelRange.y = std::max(voxelRange.y, value);
+      }
+    }
+  }
+
+  header.voxelRange[0] = voxelRange.x;
+  header.voxelRange[1] = voxelRange.y;
+}
+
+//! Write all bricks in file order, repeating the last voxel of the volume
+//! past its boundary.
+template<typename T>
+bool writeBricks(const T *voxels,
+                 const BrickedVolumeFileHeader &header,
+                 FILE *file)
+{
+  const vec3i dims(header.dimensions[0], header.dimensions[1],
+                   header.dimensions[2]);
+  const int width = header.brickWidth;
+  std::vector<char> brick(header.brickBytes, 0);
+  T *brickVoxels = (T *)brick.data();
+
+  for (int bz = 0; bz < header.brickCount[2]; bz++) {
+    for (int by = 0; by < header.brickCount[1]; by++) {
+      for (int bx = 0; bx < header.brickCount[0]; bx++) {
+        const vec3i origin = vec3i(bx, by, bz) * (width - 1);
+        for (int z = 0; z < width; z++) {
+          const size_t srcZ = std::min(origin.z + z, dims.z - 1);
+          for (int y = 0; y < width; y++) {
+            const size_t srcY = std::min(origin.y + y, dims.y - 1);
+            const T *row = voxels + dims.x * (srcY + dims.y * srcZ);
+            T *brickRow = brickVoxels + width * (y + (size_t)width * z);
+            for (int x = 0; x < width; x++)
+              brickRow[x] = row[std::min(origin.x + x, dims.x - 1)];
+          }
+        }
+        if (fwrite(brick.data(), header.brickBytes, 1, file) != 1)
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+template<typename T>
+bool convert(const T *voxels, BrickedVolumeFileHeader &header, FILE *file)
+{
+  std::vector<vec2f> cellRanges;
+  computeRanges(voxels, header, cellRanges);
+
+  // Header and cell ranges, padded up to the first brick.
+  std::vector<char> prefix(header.brickDataOffset, 0);
+  memcpy(prefix.data(), &header, sizeof(header));
+  memcpy(prefix.data() + header.cellRangeOffset, cellRanges.data(),
+         cellRanges.size() * sizeof(vec2f));
+  if (fwrite(prefix.data(), prefix.size(), 1, file) != 1)
+    return false;
+
+  return writeBricks(voxels, header, file);
+}
+
+int main(int argc, const char **argv)
+{
+  std::vector<std::string> files;
+  vec3i dims(0);
+  std::string voxelType = "uchar";
+  size_t offset = 0;
+  int brickWidth = BRICKED_VOLUME_FILE_BRICK_WIDTH;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if ((arg == "-dimensions" || arg == "-d") && i + 3 < argc) {
+      dims.x = atoi(argv[++i]);
+      dims.y = atoi(argv[++i]);
+      dims.z = atoi(argv[++i]);
+    } else if ((arg == "-voxelType" || arg == "-t") && i + 1 < argc) {
+      voxelType = argv[++i];
+    } else if (arg == "-offset" && i + 1 < argc) {
+      offset = atoll(argv[++i]);
+    } else if (arg == "-brickWidth" && i + 1 < argc) {
+      brickWidth = atoi(argv[++i]);
+    } else if (arg[0] == '-') {
+      printUsageAndExit();
+    } else {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.size() != 2 || reduce_min(dims) <= 0 || brickWidth < 2)
+    printUsageAndExit();
+
+  OSPDataType type;
+  size_t voxelSize;
+  if (voxelType == "uchar") {
+    type = OSP_UCHAR;  voxelSize = sizeof(unsigned char);
+  } else if (voxelType == "ushort") {
+    type = OSP_USHORT; voxelSize = sizeof(unsigned short);
+  } else if (voxelType == "float") {
+    type = OSP_FLOAT;  voxelSize = sizeof(float);
+  } else if (voxelType == "double") {
+    type = OSP_DOUBLE; voxelSize = sizeof(double);
+  } else {
+    cerr << "#ospRaw2Bricks: unsupported voxel type '" << voxelType << "'"
+         << endl;
+    return 1;
+  }
+
+  size_t fileSize = 0;
+  const char *input = mapFile(files[0], fileSize);
+  if (input == nullptr) {
+    cerr << "#ospRaw2Bricks: could not open '" << files[0] << "'" << endl;
+    return 1;
+  }
+
+  const size_t voxelCount = (size_t)dims.x * dims.y * dims.z;
+  if (fileSize < offset + voxelCount * voxelSize) {
+    cerr << "#ospRaw2Bricks: '" << files[0] << "' is smaller than the given "
+         << "dimensions" << endl;
+    return 1;
+  }
+
+  FILE *output = fopen(files[1].c_str(), "wb");
+  if (output == nullptr) {
+    cerr << "#ospRaw2Bricks: could not create '" << files[1] << "'" << endl;
+    return 1;
+  }
+
+  BrickedVolumeFileHeader header;
+  header.init(type, voxelSize, dims, brickWidth);
+
+  const void *voxels = input + offset;
+  bool written = false;
+  switch (type) {
+  case OSP_UCHAR:
+    written = convert((const unsigned char *)voxels, header, output);
+    break;
+  case OSP_USHORT:
+    written = convert((const unsigned short *)voxels, header, output);
+    break;
+  case OSP_FLOAT:
+    written = convert((const float *)voxels, header, output);
+    break;
+  default:
+    written = convert((const double *)voxels, header, output);
+    break;
+  }
+
+  if (fclose(output) != 0 || !written) {
+    cerr << "#ospRaw2Bricks: could not write '" << files[1] << "'" << endl;
+    return 1;
+  }
+
+  cout << "#ospRaw2Bricks: wrote " << header.numBricks() << " bricks of "
+       << brickWidth << "^3 voxels (" << (header.fileSize() >> 20)
+       << " MB) to '" << files[1] << "'" << endl;
+  return 0;
+}
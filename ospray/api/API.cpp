@@ -487,6 +487,57 @@ extern "C" float ospRenderFrame(OSPFrameBuffer fb,
 #endif
 }
 
+/*! \brief same as ospRenderFrame, but returns without waiting for the
+    frame to be finished */
+extern "C" OSPFuture ospRenderFrameAsync(OSPFrameBuffer fb,
+                                         OSPRenderer renderer,
+                                         const uint32_t fbChannelFlags)
+{
+  ASSERT_DEVICE();
+  return ospray::api::Device::current->renderFrameAsync(fb,renderer,
+                                                        fbChannelFlags);
+}
+
+extern "C" int ospIsReady(OSPFuture future)
+{
+  ASSERT_DEVICE();
+  Assert2(future, "NULL future passed to ospIsReady");
+  return ospray::api::Device::current->isReady(future);
+}
+
+extern "C" float ospWait(OSPFuture future)
+{
+  ASSERT_DEVICE();
+  Assert2(future, "NULL future passed to ospWait");
+  return ospray::api::Device::current->wait(future);
+}
+
+extern "C" void ospCancel(OSPFuture future)
+{
+  ASSERT_DEVICE();
+  Assert2(future, "NULL future passed to ospCancel");
+  ospray::api::Device::current->cancel(future);
+}
+
+extern "C" float ospGetProgress(OSPFuture future)
+{
+  ASSERT_DEVICE();
+  Assert2(future, "NULL future passed to ospGetProgress");
+  return ospray::api::Device::current->getProgress(future);
+}
+
+extern "C" int ospGetTileTimes(OSPFrameBuffer fb, float *times,
+                               int *numTilesX, int *numTilesY)
+{
+  ASSERT_DEVICE();
+  Assert2(fb, "NULL frame buffer passed to ospGetTileTimes");
+  const ospray::vec2i numTiles =
+      ospray::api::Device::current->getTileTimes(fb, times);
+  if (numTilesX) *numTilesX = numTiles.x;
+  if (numTilesY) *numTilesY = numTiles.y;
+  return numTiles.x * numTiles.y;
+}
+
 extern "C" void ospCommit(OSPObject object)
 {
   // assert(!rendering);
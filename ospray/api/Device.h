@@ -157,6 +157,49 @@ namespace ospray {
                                OSPRenderer _renderer, 
                                const uint32 fbChannelFlags) = 0;
 
+      /*! call a renderer to render a frame buffer, without waiting for
+          the frame to finish */
+      virtual OSPFuture renderFrameAsync(OSPFrameBuffer _fb,
+                                         OSPRenderer _renderer,
+                                         const uint32 fbChannelFlags)
+      {
+        throw std::runtime_error("renderFrameAsync() not implemented for "
+                                 "this device");
+      }
+
+      /*! check whether an asynchronously rendered frame is finished */
+      virtual bool isReady(OSPFuture _future)
+      {
+        throw std::runtime_error("isReady() not implemented for this device");
+      }
+
+      /*! wait for an asynchronously rendered frame to finish */
+      virtual float wait(OSPFuture _future)
+      {
+        throw std::runtime_error("wait() not implemented for this device");
+      }
+
+      /*! stop scheduling tiles of an asynchronously rendered frame */
+      virtual void cancel(OSPFuture _future)
+      {
+        throw std::runtime_error("cancel() not implemented for this device");
+      }
+
+      /*! fraction [0..1] of tiles of an asynchronously rendered frame
+          that are done */
+      virtual float getProgress(OSPFuture _future)
+      {
+        throw std::runtime_error("getProgress() not implemented for this "
+                                 "device");
+      }
+
+      /*! copy the render time of each tile in the last frame into
+          'times' (if not NULL), and return the number of tiles */
+      virtual vec2i getTileTimes(OSPFrameBuffer _fb, float *times)
+      {
+        throw std::runtime_error("getTileTimes() not implemented for this "
+                                 "device");
+      }
 
   
       //! release (i.e., reduce refcount of) given object
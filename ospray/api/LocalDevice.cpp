@@ -23,6 +23,7 @@
 #include "volume/Volume.h"
 #include "transferFunction/TransferFunction.h"
 #include "render/LoadBalancer.h"
+#include "render/RenderTask.h"
 #include "common/Material.h"
 #include "common/Library.h"
 #include "texture/Texture2D.h"
@@ -567,6 +568,7 @@ namespace ospray {
       Assert(renderer != nullptr && "invalid renderer handle");
 
       try {
+        fb->beginFrameProgress();
         return renderer->renderFrame(fb, fbChannelFlags);
       } catch (const std::runtime_error &e) {
         std::cerr << "======================================================="
@@ -579,6 +581,72 @@ namespace ospray {
       }
     }
 
+    OSPFuture LocalDevice::renderFrameAsync(OSPFrameBuffer _fb,
+                                            OSPRenderer    _renderer,
+                                            const uint32   fbChannelFlags)
+    {
+      FrameBuffer *fb       = (FrameBuffer *)_fb;
+      Renderer    *renderer = (Renderer *)_renderer;
+
+      Assert(fb != nullptr && "invalid frame buffer handle");
+      Assert(renderer != nullptr && "invalid renderer handle");
+
+      RenderTask *task = new RenderTask(fb, renderer);
+      task->refInc();
+      task->start([=]() {
+        return renderer->renderFrame(fb, fbChannelFlags);
+      });
+      return (OSPFuture)task;
+    }
+
+    bool LocalDevice::isReady(OSPFuture _future)
+    {
+      RenderTask *task = (RenderTask *)_future;
+      Assert(task != nullptr && "invalid future handle");
+      return task->isFinished();
+    }
+
+    float LocalDevice::wait(OSPFuture _future)
+    {
+      RenderTask *task = (RenderTask *)_future;
+      Assert(task != nullptr && "invalid future handle");
+
+      try {
+        return task->wait();
+      } catch (const std::runtime_error &e) {
+        std::cerr << "======================================================="
+                  << std::endl;
+        std::cerr << "# >>> ospray fatal error <<< " << std::endl << e.what()
+                  << std::endl;
+        std::cerr << "======================================================="
+                  << std::endl;
+        exit(1);
+      }
+    }
+
+    void LocalDevice::cancel(OSPFuture _future)
+    {
+      RenderTask *task = (RenderTask *)_future;
+      Assert(task != nullptr && "invalid future handle");
+      task->cancel();
+    }
+
+    float LocalDevice::getProgress(OSPFuture _future)
+    {
+      RenderTask *task = (RenderTask *)_future;
+      Assert(task != nullptr && "invalid future handle");
+      return task->getProgress();
+    }
+
+    vec2i LocalDevice::getTileTimes(OSPFrameBuffer _fb, float *times)
+    {
+      FrameBuffer *fb = (FrameBuffer*)_fb;
+      Assert(fb != nullptr && "invalid frame buffer handle");
+      if (times)
+        std::copy(fb->tileRenderTime.begin(), fb->tileRenderTime.end(), times);
+      return fb->getNumTiles();
+    }
+
     //! release (i.e., reduce refcount of) given object
     /*! Note that all objects in ospray are refcounted, so one cannot
       explicitly "delete" any object. Instead, each object is created
@@ -175,6 +175,18 @@ namespace ospray {
                                OSPRenderer _renderer,
                                const uint32 fbChannelFlags) override;
 
+      /*! call a renderer to render a frame buffer, without waiting for it */
+      OSPFuture renderFrameAsync(OSPFrameBuffer _fb,
+                                 OSPRenderer _renderer,
+                                 const uint32 fbChannelFlags) override;
+
+      bool isReady(OSPFuture _future) override;
+      float wait(OSPFuture _future) override;
+      void cancel(OSPFuture _future) override;
+      float getProgress(OSPFuture _future) override;
+
+      vec2i getTileTimes(OSPFrameBuffer _fb, float *times) override;
+
       //! release (i.e., reduce refcount of) given object
       /*! note that all objects in ospray are refcounted, so one cannot
         explicitly "delete" any object. instead, each object is created
@@ -17,12 +17,19 @@
 // ospray
 #include "Model.h"
 #include "geometry/TriangleMesh.h"
+#include "common/tasking/parallel_for.h"
 // embree
 #include "embree2/rtcore.h"
 #include "embree2/rtcore_scene.h"
 #include "embree2/rtcore_geometry.h"
 // ispc exports
 #include "Model_ispc.h"
+#include "Geometry_ispc.h"
+// stl
+#include <set>
+#include <algorithm>
+#include <exception>
+#include <mutex>
 
 
 namespace ospray {
@@ -34,12 +41,53 @@ namespace ospray {
 
   extern "C" void *ospray_getEmbreeDevice() { return g_embreeDevice; }
 
+  Model::FinalizeStats::FinalizeStats()
+    : seconds(0.), fullRebuild(false),
+      numFinalized(0), numRefitted(0), numRemoved(0),
+      numDisabled(0), numEnabled(0), numUnchanged(0)
+  {}
+
   Model::Model()
   {
     managedObjectType = OSP_MODEL;
     this->ispcEquivalent = ispc::Model_create(this);
     this->embreeSceneHandle = NULL;
+    this->finalizeCount = 0;
+    this->embreeSceneIsDynamic = false;
+  }
+
+  Model::~Model()
+  {
+    if (embreeSceneHandle) {
+      for (auto &fg : finalizedGeometry)
+        ispc::Geometry_deleteUserData(fg.first->getIE(), embreeSceneHandle,
+                                      fg.second.embreeGeomID);
+      rtcDeleteScene(embreeSceneHandle);
+    }
+  }
+
+  void Model::deleteEmbreeGeometry(const FinalizedGeometry &fg)
+  {
+    ispc::Geometry_deleteUserData(fg.geometry->getIE(), embreeSceneHandle,
+                                  fg.embreeGeomID);
+    rtcDeleteGeometry(embreeSceneHandle, fg.embreeGeomID);
+  }
+
+  void Model::createEmbreeScene(bool dynamicScene)
+  {
+    // the old scene (if any) goes away with all its embree geometries
+    if (embreeSceneHandle)
+      for (auto &fg : finalizedGeometry)
+        ispc::Geometry_deleteUserData(fg.first->getIE(), embreeSceneHandle,
+                                      fg.second.embreeGeomID);
+
+    embreeSceneHandle =
+        (RTCScene)ispc::Model_createEmbreeScene(getIE(), g_embreeDevice,
+                                                dynamicScene);
+    embreeSceneIsDynamic = dynamicScene;
+    finalizedGeometry.clear();
   }
+
   void Model::finalize()
   {
     if (logLevel >= 2) {
@@ -48,29 +96,166 @@ namespace ospray {
            << geometry.size() << " geometries and " << volume.size() << " volumes" << std::endl << std::flush;
     }
 
-    ispc::Model_init(getIE(), g_embreeDevice, geometry.size(), volume.size());
-    embreeSceneHandle = (RTCScene)ispc::Model_getEmbreeSceneHandle(getIE());
+    const double t0 = getSysTime();
+    FinalizeStats stats;
 
-    bounds = empty;
+    // NOTE: most models only ever get finalized once, so start out with
+    // a static scene (fastest to trace); the first time a model gets
+    // re-finalized we switch it over to a dynamic scene, which allows
+    // for updating individual geometries from then on.
+    if (!embreeSceneHandle) {
+      createEmbreeScene(false);
+      stats.fullRebuild = true;
+    } else if (!embreeSceneIsDynamic) {
+      createEmbreeScene(true);
+      stats.fullRebuild = true;
+    }
+
+    // bring the embree geometries we already have up to date: disable
+    // what got removed from the model (and enable what got re-added),
+    // and refit what got modified since we last finalized it - or, if
+    // the geometry cannot be refit, delete it so it gets re-created
+    std::set<Geometry *> inModel;
+    for (size_t i = 0; i < geometry.size(); i++)
+      inModel.insert(geometry[i].ptr);
+
+    auto it = finalizedGeometry.begin();
+    while (it != finalizedGeometry.end()) {
+      Geometry *geom = it->first;
+      FinalizedGeometry &fg = it->second;
+
+      if (!inModel.count(geom)) {
+        if (fg.enabled) {
+          rtcDisable(embreeSceneHandle, fg.embreeGeomID);
+          fg.enabled = false;
+          stats.numDisabled++;
+        }
+        ++it;
+        continue;
+      }
+
+      if (!fg.enabled) {
+        rtcEnable(embreeSceneHandle, fg.embreeGeomID);
+        fg.enabled = true;
+        stats.numEnabled++;
+      }
 
-    // for now, only implement triangular geometry...
+      const size_t stamp = geom->getModificationStamp();
+      if (fg.modificationStamp != stamp) {
+        if (geom->refit(this, fg.embreeGeomID)) {
+          fg.modificationStamp = stamp;
+          stats.numRefitted++;
+        } else {
+          deleteEmbreeGeometry(fg);
+          it = finalizedGeometry.erase(it);
+          stats.numRemoved++;
+          continue;
+        }
+      }
+      ++it;
+    }
+
+    // (re-)finalize whatever does not have an embree geometry (any
+    // more); geometries that support it get finalized in parallel,
+    // the others one after another afterwards
+    std::vector<Geometry *> parallelFinalize;
+    std::vector<Geometry *> serialFinalize;
+    std::set<Geometry *> scheduled;
     for (size_t i=0; i < geometry.size(); i++) {
+      Geometry *geom = geometry[i].ptr;
+      if (finalizedGeometry.count(geom) || !scheduled.insert(geom).second)
+        continue;
+      if (geom->finalizeIsThreadSafe())
+        parallelFinalize.push_back(geom);
+      else
+        serialFinalize.push_back(geom);
+    }
+
+    // NOTE: a geometry's ispc-side geomID is only valid right after
+    //       it got finalized into our scene (other models may finalize
+    //       it, too), so read it back right away
+    std::vector<uint32> parallelGeomID(parallelFinalize.size());
+    // exceptions must not escape the worker threads; keep the first
+    // one and rethrow it (unchanged) on the calling thread
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    parallel_for(parallelFinalize.size(), [&](int i) {
+      try {
+        parallelFinalize[i]->finalize(this);
+        parallelGeomID[i] =
+          ispc::Geometry_getGeomID(parallelFinalize[i]->getIE());
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error)
+          error = std::current_exception();
+      }
+    });
+    if (error)
+      std::rethrow_exception(error);
 
+    auto addFinalized = [&](Geometry *geom, uint32 embreeGeomID) {
+      FinalizedGeometry &fg = finalizedGeometry[geom];
+      fg.geometry = geom;
+      fg.embreeGeomID = embreeGeomID;
+      fg.modificationStamp = geom->getModificationStamp();
+      fg.enabled = true;
+    };
+
+    for (size_t i=0; i < parallelFinalize.size(); i++)
+      addFinalized(parallelFinalize[i], parallelGeomID[i]);
+
+    for (size_t i=0; i < serialFinalize.size(); i++) {
       if (logLevel >= 2) {
         std::cout << "=======================================================" << std::endl;
-        std::cout << "Finalizing geometry " << i << std::endl << std::flush;
+        std::cout << "Finalizing geometry " << serialFinalize[i]->toString()
+                  << std::endl << std::flush;
       }
+      serialFinalize[i]->finalize(this);
+      addFinalized(serialFinalize[i],
+                   ispc::Geometry_getGeomID(serialFinalize[i]->getIE()));
+    }
 
-      geometry[i]->finalize(this);
+    stats.numFinalized = scheduled.size();
+    stats.numUnchanged = inModel.size() - scheduled.size() - stats.numRefitted;
 
-      bounds.extend(geometry[i]->bounds);
-      ispc::Model_setGeometry(getIE(), i, geometry[i]->getIE());
+    bounds = empty;
+    uint32 maxGeomID = 0;
+    for (auto &fg : finalizedGeometry) {
+      maxGeomID = std::max(maxGeomID, fg.second.embreeGeomID);
+      if (fg.second.enabled)
+        bounds.extend(fg.first->bounds);
     }
 
+    // embree geometry IDs are no longer dense once geometries got
+    // deleted, so the ispc-side table is indexed by embree geomID
+    ispc::Model_init(getIE(),
+                     finalizedGeometry.empty() ? 0 : maxGeomID+1,
+                     volume.size());
+
+    for (auto &fg : finalizedGeometry)
+      if (fg.second.enabled)
+        ispc::Model_setGeometry(getIE(), fg.second.embreeGeomID,
+                                fg.first->getIE());
+
     for (size_t i=0; i<volume.size(); i++) 
       ispc::Model_setVolume(getIE(), i, volume[i]->getIE());
     
     rtcCommit(embreeSceneHandle);
+    finalizeCount++;
+
+    stats.seconds = getSysTime() - t0;
+    lastFinalizeStats = stats;
+
+    if (logLevel >= 1) {
+      std::cout << "#osp: model finalized in " << stats.seconds << "s ("
+                << (stats.fullRebuild ? "full rebuild" : "incremental")
+                << ", " << stats.numFinalized << " geometries finalized, "
+                << stats.numRefitted << " refit, "
+                << stats.numRemoved << " removed, "
+                << stats.numDisabled << " disabled, "
+                << stats.numEnabled << " re-enabled, "
+                << stats.numUnchanged << " unchanged)" << std::endl;
+    }
   }
 
 } // ::ospray
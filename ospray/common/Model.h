@@ -22,6 +22,7 @@
 
 // stl stuff
 #include <vector>
+#include <map>
 
 // embree stuff
 #include "embree2/rtcore.h"
@@ -36,15 +37,39 @@ namespace ospray {
     collection of geometries and volumes that one can trace rays
     against, and that one can afterwards 'query' for certain
     properties (like the shading normal or material for a given
-    ray/model intersection) */
+    ray/model intersection)
+
+    The embree scene is kept alive across commits: the first
+    finalize() builds a static scene; if the model gets finalized
+    again it is re-created once as a dynamic scene, and from then on
+    only geometries that changed since the last finalize() get
+    touched: (re-)committed geometries get refit in place if their
+    type supports it (see Geometry::refit()) and re-created
+    otherwise, removed geometries get disabled (and enabled again if
+    they get re-added), new ones get added. Everything else keeps
+    its embree geometry (and BVH) as is. */
   struct Model : public ManagedObject
   {
     Model();
+    virtual ~Model();
 
     //! \brief common function to help printf-debugging 
     virtual std::string toString() const { return "ospray::Model"; }
     virtual void finalize();
 
+    /*! \brief statistics of the last call to finalize() */
+    struct FinalizeStats {
+      FinalizeStats();
+      double seconds;        //!< wall-clock time spent in finalize()
+      bool   fullRebuild;    //!< whether the embree scene was re-created
+      size_t numFinalized;   //!< geometries (re-)finalized
+      size_t numRefitted;    //!< geometries updated in place
+      size_t numRemoved;     //!< geometries deleted from the embree scene
+      size_t numDisabled;    //!< geometries disabled (removed from model)
+      size_t numEnabled;     //!< disabled geometries that got re-added
+      size_t numUnchanged;   //!< geometries whose embree geometry was kept
+    };
+
     typedef std::vector<Ref<Geometry> > GeometryVector;
     typedef std::vector<Ref<Volume> > VolumeVector;
     
@@ -62,7 +87,39 @@ namespace ospray {
 
     //! \brief the embree scene handle for this geometry
     RTCScene embreeSceneHandle; 
+    /*! \brief serializes all modifications of 'embreeSceneHandle'
+        while geometries get finalized in parallel */
+    std::mutex embreeMutex;
     box3f bounds;
+
+    /*! \brief incremented by every finalize(), so that instances of
+        this model know when they have to be updated */
+    size_t finalizeCount;
+
+    FinalizeStats lastFinalizeStats;
+
+  private:
+    /*! (re-)create the embree scene, dropping all embree geometries */
+    void createEmbreeScene(bool dynamicScene);
+
+    /*! a geometry that currently has an embree geometry in our scene */
+    struct FinalizedGeometry {
+      Ref<Geometry> geometry;
+      /*! the ID our scene knows the geometry under; kept here rather
+          than on the geometry, which may be part of other models */
+      uint32        embreeGeomID;
+      size_t        modificationStamp; //!< geometry's stamp when finalized
+      /*! false while the geometry is not part of the model (any
+          more); its embree geometry is then disabled, not deleted */
+      bool          enabled;
+    };
+
+    //! delete the embree geometry of given entry from our scene
+    void deleteEmbreeGeometry(const FinalizedGeometry &fg);
+
+    std::map<Geometry *, FinalizedGeometry> finalizedGeometry;
+
+    bool embreeSceneIsDynamic;
   };
 
 } // ::ospray
@@ -16,13 +16,33 @@
 
 #include "TaskSys.h"
 //ospray
+#include "ospcommon/malloc.h"
 #include "ospcommon/sysinfo.h"
 #include "ospcommon/thread.h"
 //stl
+#include <deque>
+#include <new>
 #include <thread>
 #include <vector>
 
 namespace ospray {
+
+  /*! queue of tasks that have ALREADY been activated. the thread
+      owning the queue takes work from the back, all other threads
+      steal from the front. a task stays in the queue until all of its
+      jobs have been started, so several threads can work on the same
+      task concurrently */
+  struct __aligned(64) TaskQueue {
+
+    //! push a task; the queue takes over the reference taken in schedule()
+    inline void push(Task *task, bool ownerEnd);
+    //! get the next task from the given end of the queue (or null if empty)
+    inline Ref<Task> get(bool ownerEnd);
+
+    Mutex mutex;
+    std::deque<Task*> tasks;
+  };
+
   struct TaskSys {
     bool initialized;
     bool running;
@@ -30,30 +50,80 @@ namespace ospray {
     void init(size_t maxNumRenderTasks);
     static TaskSys global;
     static void *threadStub(void *);
-    inline Ref<Task> getNextActiveTask();
+    inline Ref<Task> getNextActiveTask(ssize_t queueID);
+    inline Ref<Task> waitForNextActiveTask(ssize_t queueID);
+    inline void taskAvailable();
 
-    //! Queue of tasks that have ALREADY been acitvated, and that are ready
-    //! to run
-    __aligned(64) Task *volatile activeListFirst;
-    __aligned(64) Task *volatile activeListLast;
+    //! one queue per worker thread
+    std::vector<TaskQueue *> queues;
+    //! queue for tasks that got scheduled from non-worker threads
+    TaskQueue injectionQueue;
 
+    //! state used to put idle workers to sleep (and to wake them up)
+    std::atomic<size_t> __aligned(64) numActivations;
+    AtomicInt __aligned(64) numSleeping;
     Mutex     __aligned(64) mutex;
     Condition __aligned(64) tasksAvailable;
 
-    void threadFunction();
+    void threadFunction(size_t threadID);
 
     std::vector<thread_t> threads;
 
     TaskSys()
-      : activeListFirst(nullptr), activeListLast(nullptr),
-        initialized(false), running(false)
+      : initialized(false), running(false),
+        numActivations(0), numSleeping(0)
     {}
 
     ~TaskSys();
   };
-  
+
   TaskSys __aligned(64) TaskSys::global;
 
+  //! queue of the calling thread (-1 for non-worker threads)
+  static __thread ssize_t thisThreadQueueID = -1;
+
+  //! number of failed rounds of stealing before an idle worker sleeps
+  static const int NUM_STEAL_ROUNDS_BEFORE_SLEEP = 64;
+
+  inline void TaskQueue::push(Task *task, bool ownerEnd)
+  {
+    SCOPED_LOCK(mutex);
+    if (ownerEnd)
+      tasks.push_back(task);
+    else
+      tasks.push_front(task);
+  }
+
+  inline Ref<Task> TaskQueue::get(bool ownerEnd)
+  {
+    // NOTE: tasks whose jobs have all been started get removed lazily,
+    //       by whichever thread finds them first
+    std::vector<Task *> exhausted;
+    Ref<Task> result;
+    {
+      SCOPED_LOCK(mutex);
+      while (!tasks.empty()) {
+        Task *task = ownerEnd ? tasks.back() : tasks.front();
+        if (task->numJobsStarted < task->numJobsInTask) {
+          result = task;
+          break;
+        }
+        if (ownerEnd)
+          tasks.pop_back();
+        else
+          tasks.pop_front();
+        exhausted.push_back(task);
+      }
+    }
+
+    // release the queue's references outside of the lock, this may
+    // delete the task
+    for (auto *task : exhausted)
+      task->refDec();
+
+    return result;
+  }
+
   inline void Task::workOnIt() 
   {
     size_t myCompleted = 0;
@@ -82,6 +152,10 @@ namespace ospray {
       return;
     }
 
+    // NOTE: once all jobs of this task are started we only block
+    //       instead of stealing other tasks while waiting; stealing
+    //       here would nest arbitrary (e.g. tile) tasks on this
+    //       thread's stack.
     if (workOnIt) {
       this->workOnIt();
     }
@@ -96,29 +170,69 @@ namespace ospray {
     wait();
   }
 
-  inline Ref<Task> TaskSys::getNextActiveTask()
+  inline Ref<Task> TaskSys::getNextActiveTask(ssize_t queueID)
   {
-    while (1) {
+    // first, look at our own queue...
+    if (queueID >= 0) {
+      Ref<Task> task = queues[queueID]->get(true);
+      if (task)
+        return task;
+    }
+
+    // ...then at what the application threads have scheduled...
+    Ref<Task> task = injectionQueue.get(false);
+    if (task)
+      return task;
+
+    // ...and finally try to steal from the other workers, starting
+    // with our neighbor so not all thieves hit the same victim
+    const size_t numQueues = queues.size();
+    const size_t first = queueID >= 0 ? queueID + 1 : 0;
+    for (size_t i = 0; i < numQueues; ++i) {
+      const size_t victim = (first + i) % numQueues;
+      if ((ssize_t)victim == queueID)
+        continue;
+      task = queues[victim]->get(false);
+      if (task)
+        return task;
+    }
+
+    return nullptr;
+  }
+
+  inline Ref<Task> TaskSys::waitForNextActiveTask(ssize_t queueID)
+  {
+    while (running) {
+      const size_t seenActivations = numActivations;
+
+      for (int i = 0; i < NUM_STEAL_ROUNDS_BEFORE_SLEEP; ++i) {
+        Ref<Task> task = getNextActiveTask(queueID);
+        if (task)
+          return task;
+        yield();
+      }
+
+      // nothing to do, go to sleep until a new task gets activated
       std::unique_lock<std::mutex> lock(mutex);
+      numSleeping++;
       tasksAvailable.wait(lock, [&](){
-        return !(activeListFirst == nullptr && running);
+        return !running || numActivations != seenActivations;
       });
+      numSleeping--;
+    }
 
-      if (!running) {
-        return nullptr;
-      }
+    return nullptr;
+  }
 
-      Ref<Task> front = activeListFirst;
-      if (front->numJobsStarted >= front->numJobsInTask) {
-        if (activeListFirst == activeListLast) {
-          activeListFirst = activeListLast = nullptr;
-        } else {
-          activeListFirst = activeListFirst->next;
-        }
-        continue;
-      }
-      assert(front.ptr);
-      return front;
+  inline void TaskSys::taskAvailable()
+  {
+    // NOTE: both numActivations and numSleeping are sequentially
+    //       consistent, so either a worker going to sleep sees the new
+    //       activation, or we see the sleeping worker and wake it up
+    numActivations++;
+    if (numSleeping > 0) {
+      SCOPED_LOCK(mutex);
+      tasksAvailable.notify_all();
     }
   }
     
@@ -139,33 +253,30 @@ namespace ospray {
 
   inline void Task::activate()
   {
-    if (!TaskSys::global.initialized)
+    TaskSys &ts = TaskSys::global;
+
+    if (!ts.initialized)
       throw std::runtime_error("TASK SYSTEM NOT YET INITIALIZED");
-    {
-      SCOPED_LOCK(TaskSys::global.mutex);
-      bool wasEmpty = TaskSys::global.activeListFirst == nullptr;
-      if (wasEmpty) {
-        TaskSys::global.activeListFirst = TaskSys::global.activeListLast = this;
-        this->next = nullptr;
-        TaskSys::global.tasksAvailable.notify_all();
-      } else {
-        if (order == Task::BACK_OF_QUEUE) {
-          this->next = nullptr;
-          TaskSys::global.activeListLast->next = this;
-          TaskSys::global.activeListLast = this;
-        } else {
-          this->next = TaskSys::global.activeListFirst;
-          TaskSys::global.activeListFirst = this;
-        }
-      }
-      status = Task::ACTIVE;
+
+    status = Task::ACTIVE;
+
+    // NOTE: a worker's own end of its queue is the back, the injection
+    //       queue is only ever read from the front
+    const ssize_t queueID = thisThreadQueueID;
+    if (queueID >= 0) {
+      ts.queues[queueID]->push(this, order == Task::FRONT_OF_QUEUE);
+    } else {
+      ts.injectionQueue.push(this, order == Task::BACK_OF_QUEUE);
     }
+
+    ts.taskAvailable();
   }
 
-  void TaskSys::threadFunction()
+  void TaskSys::threadFunction(size_t threadID)
   {
+    thisThreadQueueID = threadID;
     while (1) {
-      Ref<Task> task = getNextActiveTask();
+      Ref<Task> task = waitForNextActiveTask(threadID);
       if (!running) {
         return;
       }
@@ -176,16 +287,23 @@ namespace ospray {
 
   TaskSys::~TaskSys()
   {
-    running = false;
-    tasksAvailable.notify_all();
+    {
+      SCOPED_LOCK(mutex);
+      running = false;
+      tasksAvailable.notify_all();
+    }
     for (int i = 0; i < threads.size(); ++i) {
       join(threads[i]);
     }
+    for (auto *queue : queues) {
+      queue->~TaskQueue();
+      alignedFree(queue);
+    }
   }
 
-  void *TaskSys::threadStub(void *)
+  void *TaskSys::threadStub(void *arg)
   {
-    TaskSys::global.threadFunction();
+    TaskSys::global.threadFunction((size_t)arg);
     return nullptr;
   }
 
@@ -207,10 +325,17 @@ namespace ospray {
 #endif
     }
 
+    /* generate one queue per worker before any worker starts stealing;
+       plain 'new' does not honor the queue's cache line alignment */
+    for (size_t t=1; t<numThreads; t++) {
+      void *mem = alignedMalloc(sizeof(TaskQueue), alignof(TaskQueue));
+      queues.push_back(new (mem) TaskQueue);
+    }
+
     /* generate all threads */
     for (size_t t=1; t<numThreads; t++) {
       threads.push_back(createThread((thread_func)TaskSys::threadStub,
-                                     (void*)-1,4*1024*1024,-1));
+                                     (void*)(t-1),4*1024*1024,-1));
     }
   }
 }//namespace ospray
@@ -59,6 +59,12 @@ namespace ospray {
     /*! \brief initialize the task system with given number of worker
         tasks.
 
+        every worker thread owns its own task deque; tasks scheduled
+        from within a worker go into that worker's deque, and idle
+        workers steal from the deques of others. tasks scheduled from
+        non-worker (i.e., application) threads go into a shared
+        injection queue.
+
         numThreads==-1 means 'use all that are available; numThreads=0
         means 'no worker thread, assume that whoever calls wait() will
         do the work */
@@ -69,7 +75,8 @@ namespace ospray {
     //! Allow tasking system backend to access all parts of the class, but
     //! prevent users from using data which is an implementation detail of the
     //! task
-    friend class TaskSys;
+    friend struct TaskSys;
+    friend struct TaskQueue;
 
     // ------------------------------------------------------------------
     // callback used to define what the task is doing
@@ -100,7 +107,6 @@ namespace ospray {
     Condition __aligned(64) allDependenciesFulfilledCond;
     Condition __aligned(64) allJobsCompletedCond;
 
-    __aligned(64) Task *volatile next;
     const char *name;
   };
 
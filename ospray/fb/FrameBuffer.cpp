@@ -31,10 +31,24 @@ namespace ospray {
       colorBufferFormat(colorBufferFormat),
       hasDepthBuffer(hasDepthBuffer),
       hasAccumBuffer(hasAccumBuffer),
-      hasVarianceBuffer(hasVarianceBuffer)
+      hasVarianceBuffer(hasVarianceBuffer),
+      numTilesDoneThisFrame(0),
+      frameCancelled(false)
   {
     managedObjectType = OSP_FRAMEBUFFER;
     Assert(size.x > 0 && size.y > 0);
+    tileRenderTime.resize(getTotalTiles(), 0.f);
+  }
+
+  void FrameBuffer::beginFrameProgress()
+  {
+    numTilesDoneThisFrame = 0;
+    frameCancelled = false;
+  }
+
+  float FrameBuffer::getFrameProgress() const
+  {
+    return std::min(1.f, numTilesDoneThisFrame / float(getTotalTiles()));
   }
 
   /*! helper function for debugging. write out given pixels in PPM format */
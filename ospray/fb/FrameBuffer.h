@@ -86,6 +86,41 @@ namespace ospray {
     virtual float endFrame(const float errorThreshold) = 0;
 
     Ref<PixelOp::Instance> pixelOp;
+
+    // ------------------------------------------------------------------
+    // frame progress and cancellation (used for asynchronous rendering)
+    // ------------------------------------------------------------------
+
+    //! reset progress and cancellation state for a new frame
+    void beginFrameProgress();
+
+    //! report that one more tile of the current frame is done
+    void reportTileDone() { numTilesDoneThisFrame++; }
+
+    //! fraction [0..1] of tiles of the current frame that are done
+    float getFrameProgress() const;
+
+    /*! tell the load balancer to not schedule any more tiles for the
+        current frame */
+    void cancelFrame() { frameCancelled = true; }
+
+    bool isFrameCancelled() const { return frameCancelled; }
+
+    AtomicInt numTilesDoneThisFrame;
+    std::atomic<bool> frameCancelled;
+
+    // ------------------------------------------------------------------
+    // per-tile render times (used for cost-based tile scheduling)
+    // ------------------------------------------------------------------
+
+    //! record how long (in seconds) the given tile took this frame
+    void setTileRenderTime(int tileIndex, float seconds)
+    { tileRenderTime[tileIndex] = seconds; }
+
+    /*! render time of each tile (row by row) in the frame it was last
+        rendered in; 0 for tiles that were never rendered, or that were
+        skipped because they had converged */
+    std::vector<float> tileRenderTime;
   };
 
   /*! helper function for debugging. write out given pixels in PPM
@@ -64,6 +64,7 @@ namespace ospray {
       _materialList = (void*)ispcMaterials;
     }
 
+    std::lock_guard<std::mutex> lock(model->embreeMutex);
     ispc::CylindersGeometry_set(getIE(),model->getIE(),
                                 cylinderData->data,_materialList,
                                 colorData?(ispc::vec4f*)colorData->data:NULL,
@@ -45,6 +45,11 @@ namespace ospray {
   }
 
 
+  void Geometry::commit()
+  {
+    commitCount++;
+  }
+
   /*! \brief creates an abstract geometry class of given type 
     
     The respective geometry type must be a registered geometry type
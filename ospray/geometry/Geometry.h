@@ -37,7 +37,11 @@ namespace ospray {
   struct Geometry : public ManagedObject
   {
     //! constructor
-    Geometry() : bounds(empty) { managedObjectType = OSP_GEOMETRY; }
+    Geometry() : bounds(empty), commitCount(0)
+    { managedObjectType = OSP_GEOMETRY; }
+
+    //! \brief marks this geometry as modified, see getModificationStamp()
+    virtual void commit();
 
     //! set given geometry's material. 
     /*! all material assignations should go through this function; the
@@ -57,6 +61,23 @@ namespace ospray {
         model's acceleration structure */
     virtual void finalize(Model *model) {}
 
+    /*! \brief whether finalize() may run concurrently with finalize()
+        of other geometries of the same model. Geometries that return
+        true must hold model->embreeMutex for every call that modifies
+        the model's embree scene. */
+    virtual bool finalizeIsThreadSafe() const { return false; }
+
+    /*! \brief updates the embree geometry 'embreeGeomID' that this
+        geometry created in 'model' earlier in place, after it got
+        modified (e.g., vertices moved). Returns false if that is not
+        possible, the model then deletes and re-finalizes it */
+    virtual bool refit(Model *model, uint32 embreeGeomID) { return false; }
+
+    /*! \brief returns a value that changes whenever this geometry got
+        modified in a way that requires the models it is part of to
+        finalize it again (by default, whenever it got committed) */
+    virtual size_t getModificationStamp() const { return commitCount; }
+
     /*! \brief creates an abstract geometry class of given type 
 
       The respective geometry type must be a registered geometry type
@@ -67,6 +88,10 @@ namespace ospray {
 
     box3f bounds;
 
+  protected:
+    //! number of times this geometry got committed
+    size_t commitCount;
+
   private:
     //! material associated to this geometry
     /*! this field is private to make sure it is only set through
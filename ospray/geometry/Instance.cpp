@@ -29,6 +29,12 @@ namespace ospray {
     this->ispcEquivalent = ispc::InstanceGeometry_create(this);
   }
 
+  size_t Instance::getModificationStamp() const
+  {
+    const Model *instanced = instancedScene.ptr;
+    return commitCount + (instanced ? instanced->finalizeCount : 0);
+  }
+
   void Instance::finalize(Model *model) 
   {
     xfm.l.vx = getParam3f("xfm.l.vx",vec3f(1.f,0.f,0.f));
@@ -86,7 +92,8 @@ namespace ospray {
     ispc::InstanceGeometry_set(getIE(),
                                (ispc::AffineSpace3f&)xfm,
                                (ispc::AffineSpace3f&)rcp_xfm,
-                               instancedScene->getIE());
+                               instancedScene->getIE(),
+                               embreeGeomID);
   }
 
   OSP_REGISTER_GEOMETRY(Instance,instance);
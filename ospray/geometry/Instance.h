@@ -55,6 +55,9 @@ namespace ospray {
     /*! \brief integrates this geometry's primitives into the respective
         model's acceleration structure */
     virtual void finalize(Model *model);
+    /*! \brief also changes whenever the instanced model got finalized
+        again, since that changes the bounds of this instance */
+    virtual size_t getModificationStamp() const;
 
     /*! transformation matrix associated with that instance's geometry. may be embree::one */
     AffineSpace3f xfm;
@@ -42,6 +42,7 @@ namespace ospray {
     numIsovalues = isovaluesData->numItems;
     isovalues    = (float*)isovaluesData->data;
 
+    std::lock_guard<std::mutex> lock(model->embreeMutex);
     ispc::Isosurfaces_set(getIE(), model->getIE(), numIsovalues, isovalues, volume->getIE());
   }
 
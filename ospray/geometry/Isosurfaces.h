@@ -58,6 +58,7 @@ namespace ospray {
     /*! \brief integrates this geometry's primitives into the respective
       model's acceleration structure */
     virtual void finalize(Model *model);
+    virtual bool finalizeIsThreadSafe() const { return true; }
 
     Ref<Data> isovaluesData; //!< refcounted data array for isovalues data
     Ref<Volume> volume;
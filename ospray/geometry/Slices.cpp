@@ -41,6 +41,7 @@ namespace ospray {
     numPlanes = planesData->numItems;
     planes    = (const vec4f*)planesData->data;
 
+    std::lock_guard<std::mutex> lock(model->embreeMutex);
     ispc::Slices_set(getIE(), model->getIE(), numPlanes, (ispc::vec4f*)planes, volume->getIE());
   }
 
@@ -54,6 +54,7 @@ namespace ospray {
     /*! \brief integrates this geometry's primitives into the respective
       model's acceleration structure */
     virtual void finalize(Model *model);
+    virtual bool finalizeIsThreadSafe() const { return true; }
 
     Ref<Data> planesData; //!< refcounted data array for planes data
     Ref<Volume> volume;
@@ -88,6 +88,7 @@ namespace ospray {
       _materialList = (void*)ispcMaterials;
     }
 
+    std::lock_guard<std::mutex> lock(model->embreeMutex);
     ispc::SpheresGeometry_set(getIE(),model->getIE(),
                               sphereData->data,_materialList,
                               colorData?(unsigned char*)colorData->data:NULL,
@@ -60,6 +60,7 @@ namespace ospray {
     /*! \brief integrates this geometry's primitives into the respective
       model's acceleration structure */
     virtual void finalize(Model *model);
+    virtual bool finalizeIsThreadSafe() const { return true; }
 
     float radius;   //!< default radius, if no per-sphere radius was specified.
     int32 materialID;
@@ -52,6 +52,7 @@ namespace ospray {
               << "#segments=" << numSegments << ", "
               << "radius=" << radius << std::endl;
     
+    std::lock_guard<std::mutex> lock(model->embreeMutex);
     ispc::StreamLineGeometry_set(getIE(),model->getIE(),radius,
                                  (ispc::vec3fa*)vertex,numVertices,
                                  (uint32_t*)index,numSegments,
@@ -85,6 +85,7 @@ namespace ospray {
     /*! \brief integrates this geometry's primitives into the respective
       model's acceleration structure */
     virtual void finalize(Model *model);
+    virtual bool finalizeIsThreadSafe() const { return true; }
 
     Ref<Data> vertexData;  //!< refcounted data array for vertex data
     Ref<Data> indexData; //!< refcounted data array for segment data
@@ -30,9 +30,11 @@
 #include "embree2/rtcore.h"
 #include "embree2/rtcore_scene.h"
 #include "embree2/rtcore_geometry.h"
+#include "common/tasking/parallel_for.h"
 // ispc exports
 #include "TriangleMesh_ispc.h"
 #include <cmath>
+#include <algorithm>
 
 #define RTC_INVALID_ID RTC_INVALID_GEOMETRY_ID
 
@@ -45,6 +47,50 @@ namespace ospray {
     return i >= i0 && i < i1;
   }
 
+  /*! bounds of vertices [begin,end) of an array with STRIDE floats
+      per vertex; written such that the compiler can keep lo/hi in
+      one SIMD register each */
+  template<int STRIDE>
+  static box3f computeBlockBounds(const float *vertex,
+                                  size_t begin, size_t end)
+  {
+    float lo[STRIDE], hi[STRIDE];
+    for (int k=0;k<STRIDE;k++) {
+      lo[k] = +std::numeric_limits<float>::infinity();
+      hi[k] = -std::numeric_limits<float>::infinity();
+    }
+    for (size_t i=begin;i<end;i++) {
+      const float *v = vertex + i*STRIDE;
+      for (int k=0;k<STRIDE;k++) {
+        lo[k] = std::min(lo[k],v[k]);
+        hi[k] = std::max(hi[k],v[k]);
+      }
+    }
+    return box3f(vec3f(lo[0],lo[1],lo[2]),vec3f(hi[0],hi[1],hi[2]));
+  }
+
+  /*! parallel bounds reduction over the vertex array */
+  static box3f computeBounds(const float *vertex, size_t numVerts,
+                             size_t numCompsInVtx)
+  {
+    const size_t blockSize = 64*1024;
+    const size_t numBlocks = (numVerts+blockSize-1)/blockSize;
+    std::vector<box3f> blockBounds(numBlocks);
+
+    parallel_for(numBlocks, [&](int blockID) {
+      const size_t begin = blockID*blockSize;
+      const size_t end   = std::min(begin+blockSize,numVerts);
+      blockBounds[blockID] = numCompsInVtx == 4
+        ? computeBlockBounds<4>(vertex,begin,end)
+        : computeBlockBounds<3>(vertex,begin,end);
+    });
+
+    box3f bounds = empty;
+    for (size_t i=0;i<numBlocks;i++)
+      bounds.extend(blockBounds[i]);
+    return bounds;
+  }
+
   TriangleMesh::TriangleMesh() 
     : eMesh(RTC_INVALID_ID)
   {
@@ -55,8 +101,8 @@ namespace ospray {
 
   void TriangleMesh::finalize(Model *model)
   {
-    static int numPrints = 0;
-    numPrints++;
+    static std::atomic<int> numPrintsCounter(0);
+    const int numPrints = ++numPrintsCounter;
     if (logLevel >= 2) 
       if (numPrints == 5)
         cout << "(all future printouts for triangle mesh creation will be emitted)" << endl;
@@ -151,8 +197,21 @@ namespace ospray {
 #endif
 
 
-    eMesh = rtcNewTriangleMesh(embreeSceneHandle,RTC_GEOMETRY_STATIC,
-                               numTris,numVerts);
+    {
+      std::lock_guard<std::mutex> lock(model->embreeMutex);
+      // a mesh that got committed again is likely to keep moving, so
+      // let embree refit rather than rebuild it on refit()
+      eMesh = rtcNewTriangleMesh(embreeSceneHandle,
+                                 commitCount > 1 ? RTC_GEOMETRY_DEFORMABLE
+                                                 : RTC_GEOMETRY_STATIC,
+                                 numTris,numVerts);
+      rtcSetBuffer(embreeSceneHandle,eMesh,RTC_VERTEX_BUFFER,
+                   (void*)this->vertex,0,
+                   sizeOf(vertexData->type));
+      rtcSetBuffer(embreeSceneHandle,eMesh,RTC_INDEX_BUFFER,
+                   (void*)this->index,0,
+                   sizeOf(indexData->type));
+    }
 #ifndef NDEBUG
     {
       cout << "#osp/trimesh: Verifying index buffer ... " << endl;
@@ -178,17 +237,7 @@ namespace ospray {
     }    
 #endif
 
-    rtcSetBuffer(embreeSceneHandle,eMesh,RTC_VERTEX_BUFFER,
-                 (void*)this->vertex,0,
-                 sizeOf(vertexData->type));
-    rtcSetBuffer(embreeSceneHandle,eMesh,RTC_INDEX_BUFFER,
-                 (void*)this->index,0,
-                 sizeOf(indexData->type));
-
-    bounds = empty;
-    
-    for (int i=0;i<numVerts*numCompsInVtx;i+=numCompsInVtx) 
-      bounds.extend(*(vec3f*)(vertex + i));
+    bounds = computeBounds(vertex,numVerts,numCompsInVtx);
 
     if (logLevel >= 2) 
       if (numPrints < 5) {
@@ -213,6 +262,44 @@ namespace ospray {
                            (uint32*)prim_materialID);
   }
 
+  bool TriangleMesh::refit(Model *model, uint32 embreeGeomID)
+  {
+    // only vertex positions can be updated in place; anything that
+    // changes the topology, the attributes, or the materials requires
+    // re-creating the mesh
+    Data *newVertexData = getParamData("vertex",getParamData("position"));
+    if (!newVertexData || !vertexData
+        || newVertexData->type != vertexData->type
+        || newVertexData->numItems != vertexData->numItems
+        || getParamData("index",getParamData("triangle")) != indexData.ptr
+        || getParamData("vertex.normal",getParamData("normal")) != normalData.ptr
+        || getParamData("vertex.color",getParamData("color")) != colorData.ptr
+        || getParamData("vertex.texcoord",getParamData("texcoord")) != texcoordData.ptr
+        || getParamData("prim.materialID") != prim_materialIDData.ptr
+        || getParamData("materialList") != materialListData.ptr
+        || getParam1i("geom.materialID",-1) != geom_materialID)
+      return false;
+
+    vertexData = newVertexData;
+    vertex = (float*)vertexData->data;
+
+    const size_t numCompsInVtx = vertexData->type == OSP_FLOAT3 ? 3 : 4;
+    const size_t numVerts = vertexData->type == OSP_FLOAT
+      ? vertexData->size() / 4 : vertexData->size();
+
+    {
+      std::lock_guard<std::mutex> lock(model->embreeMutex);
+      rtcSetBuffer(model->embreeSceneHandle,embreeGeomID,RTC_VERTEX_BUFFER,
+                   (void*)this->vertex,0,
+                   sizeOf(vertexData->type));
+      rtcUpdate(model->embreeSceneHandle,embreeGeomID);
+    }
+
+    bounds = computeBounds(vertex,numVerts,numCompsInVtx);
+    ispc::TriangleMesh_setVertex(getIE(),(float*)vertex);
+    return true;
+  }
+
   OSP_REGISTER_GEOMETRY(TriangleMesh,triangles);
   OSP_REGISTER_GEOMETRY(TriangleMesh,trianglemesh);
 
@@ -75,6 +75,8 @@ namespace ospray {
     TriangleMesh();
     virtual std::string toString() const { return "ospray::TriangleMesh"; }
     virtual void finalize(Model *model);
+    virtual bool finalizeIsThreadSafe() const { return true; }
+    virtual bool refit(Model *model, uint32 embreeGeomID);
 
     const int    *index;  //!< mesh's triangle index array
     const float  *vertex; //!< mesh's vertex array
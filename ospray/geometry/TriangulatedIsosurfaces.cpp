@@ -0,0 +1,92 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+// ospray
+#include "TriangulatedIsosurfaces.h"
+#include "common/Data.h"
+#include "common/Model.h"
+// ispc-generated files
+#include "TriangulatedIsosurfaces_ispc.h"
+
+namespace ospray {
+
+  void TriangulatedIsosurfaces::finalize(Model *model)
+  {
+    isovaluesData = getParamData("isovalues", NULL);
+    volume = dynamic_cast<StructuredVolume *>(getParamObject("volume", NULL));
+
+    if (!isovaluesData || isovaluesData->numItems == 0)
+      throw std::runtime_error("triangulated isosurfaces need 'isovalues'");
+    if (!volume)
+      throw std::runtime_error("triangulated isosurfaces need a structured"
+                               " 'volume'");
+
+    const int numIsovalues = isovaluesData->numItems;
+    const float *isovalues = (const float *)isovaluesData->data;
+
+    // Extract (or look up) the mesh of each isovalue.
+    meshes.clear();
+    size_t numVertices = 0;
+    for (int i = 0; i < numIsovalues; i++) {
+      meshes.push_back(volume->getIsosurfaceMesh(isovalues[i]));
+      numVertices += meshes.back()->vertex.size();
+    }
+
+    if (numVertices > (size_t)std::numeric_limits<int32>::max())
+      throw std::runtime_error("triangulated isosurfaces have too many"
+                               " vertices for a triangle mesh");
+
+    std::vector<vec4f> isovalueColors(numIsovalues);
+    ispc::TriangulatedIsosurfaces_getColors(volume->getIE(), isovalues,
+                                            numIsovalues,
+                                            (ispc::vec4f *)isovalueColors.data());
+
+    // Concatenate the meshes. Their triangles don't share vertices, so the
+    // index array just enumerates the vertices.
+    Ref<Data> vertex = new Data(numVertices, OSP_FLOAT3A, nullptr, 0);
+    Ref<Data> normal = new Data(numVertices, OSP_FLOAT3A, nullptr, 0);
+    Ref<Data> color = new Data(numVertices, OSP_FLOAT4, nullptr, 0);
+    Ref<Data> index = new Data(numVertices / 3, OSP_INT3, nullptr, 0);
+
+    size_t begin = 0;
+    for (int i = 0; i < numIsovalues; i++) {
+      const StructuredVolume::IsosurfaceMesh &mesh = *meshes[i];
+      const size_t count = mesh.vertex.size();
+      std::copy(mesh.vertex.begin(), mesh.vertex.end(),
+                (vec3fa *)vertex->data + begin);
+      std::copy(mesh.normal.begin(), mesh.normal.end(),
+                (vec3fa *)normal->data + begin);
+      std::fill((vec4f *)color->data + begin,
+                (vec4f *)color->data + begin + count, isovalueColors[i]);
+      begin += count;
+    }
+
+    int32 *indices = (int32 *)index->data;
+    for (size_t i = 0; i < numVertices; i++)
+      indices[i] = i;
+
+    set("vertex", (ManagedObject *)vertex.ptr);
+    set("vertex.normal", (ManagedObject *)normal.ptr);
+    set("vertex.color", (ManagedObject *)color.ptr);
+    set("index", (ManagedObject *)index.ptr);
+
+    TriangleMesh::finalize(model);
+  }
+
+  OSP_REGISTER_GEOMETRY(TriangulatedIsosurfaces, triangulated_isosurfaces);
+
+} // ::ospray
@@ -0,0 +1,77 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+#include "TriangleMesh.h"
+#include "volume/StructuredVolume.h"
+
+namespace ospray {
+
+  /*! \defgroup geometry_triangulated_isosurfaces Triangulated Isosurfaces ("triangulated_isosurfaces")
+
+    \ingroup ospray_supported_geometries
+
+    \brief Isosurfaces of a structured volume, extracted into a triangle mesh
+
+    Takes the same parameters as \ref geometry_isosurfaces, but instead
+    of intersecting the volume implicitly, the isosurfaces get extracted
+    with marching cubes into a triangle mesh when the geometry is
+    committed. For isovalues that stay fixed, intersecting the triangles
+    is much cheaper than stepping through the volume, in particular for
+    the many secondary rays of the path tracer. Each isosurface is colored
+    according to the volume's transfer function at the time of the
+    commit.
+
+    Parameters:
+    <dl>
+    <dt><li><code>Data<float> isovalues</code></dt><dd> Array of floats for all isovalues in this geometry.</dd>
+    <dt><li><code>Volume  volume </code></dt><dd> The structured volume to be isosurfaced.</dd>
+    </dl>
+
+    The functionality for this geometry is implemented via the
+    \ref ospray::TriangulatedIsosurfaces class.
+  */
+
+  /*! \brief A triangle mesh of the isosurfaces of a structured volume
+
+    Implements the \ref geometry_triangulated_isosurfaces geometry. The
+    meshes are cached by the volume per isovalue, so committing the
+    geometry again with unchanged isovalues and voxels does not extract
+    them again.
+  */
+  struct TriangulatedIsosurfaces : public TriangleMesh
+  {
+    //! \brief common function to help printf-debugging
+    virtual std::string toString() const override
+    { return "ospray::TriangulatedIsosurfaces"; }
+
+    /*! \brief extracts the isosurfaces, and integrates their triangles
+      into the respective model's acceleration structure */
+    virtual void finalize(Model *model) override;
+
+    //! Extraction runs in parallel itself, and may be shared by geometries.
+    virtual bool finalizeIsThreadSafe() const override { return false; }
+
+    Ref<Data> isovaluesData; //!< refcounted data array for isovalues data
+    Ref<StructuredVolume> volume;
+
+    //! The meshes of the isovalues, kept alive in the volume's cache.
+    std::vector<std::shared_ptr<const StructuredVolume::IsosurfaceMesh>> meshes;
+  };
+
+} // ::ospray
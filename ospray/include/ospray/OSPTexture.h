@@ -39,6 +39,7 @@ typedef enum {
 /*! flags that can be passed to ospNewTexture2D(); can be OR'ed together */
 typedef enum {
   OSP_TEXTURE_SHARED_BUFFER = (1<<0),
-  OSP_TEXTURE_FILTER_NEAREST = (1<<1) /*!< use nearest-neighbor interpolation rather than the default bilinear interpolation */
+  OSP_TEXTURE_FILTER_NEAREST = (1<<1), /*!< use nearest-neighbor interpolation rather than the default bilinear interpolation */
+  OSP_TEXTURE_MIPMAP = (1<<2) /*!< generate mip-maps at creation and filter minified lookups by the ray footprint; ignored with OSP_TEXTURE_FILTER_NEAREST. The mip-maps are not updated if a shared buffer changes */
 } OSPTextureCreationFlags;
 
@@ -186,6 +186,7 @@ namespace osp {
   struct Texture2D        : public ManagedObject {};
   struct Light            : public ManagedObject {};
   struct PixelOp          : public ManagedObject {};
+  struct Future           : public ManagedObject {};
 } // ::osp
 
 typedef osp::FrameBuffer       *OSPFrameBuffer;
@@ -201,6 +202,7 @@ typedef osp::TransferFunction  *OSPTransferFunction;
 typedef osp::Texture2D         *OSPTexture2D;
 typedef osp::ManagedObject     *OSPObject;
 typedef osp::PixelOp           *OSPPixelOp;
+typedef osp::Future            *OSPFuture;
 
 /* C++ DOES support default initializers */
 #define OSP_DEFAULT_VAL(a) a
@@ -236,7 +238,8 @@ typedef struct _OSPManagedObject *OSPManagedObject,
   *OSPTransferFunction,
   *OSPTexture2D,
   *OSPObject,
-  *OSPPixelOp;
+  *OSPPixelOp,
+  *OSPFuture;
 
 /* C99 does NOT support default initializers, so we use this macro
    to define them away */
@@ -276,6 +279,48 @@ extern "C" {
                                         OSPRenderer,
                                         const uint32_t frameBufferChannels OSP_DEFAULT_VAL(=OSP_FB_COLOR));
 
+  //! use renderer to render a frame, without waiting for it to finish
+  /*! Same as ospRenderFrame(), but returns immediately with a handle
+    to the frame being rendered. The frame buffer must not be mapped,
+    cleared or used for another frame before the frame is finished
+    (see ospWait()/ospIsReady()). The handle has to be freed with
+    ospRelease(). */
+  OSPRAY_INTERFACE OSPFuture ospRenderFrameAsync(OSPFrameBuffer,
+                                                 OSPRenderer,
+                                                 const uint32_t frameBufferChannels OSP_DEFAULT_VAL(=OSP_FB_COLOR));
+
+  //! returns 1 if the given asynchronously rendered frame is finished, else 0
+  OSPRAY_INTERFACE int ospIsReady(OSPFuture);
+
+  //! wait for an asynchronously rendered frame to finish
+  /*! returns the same as ospRenderFrame() would have returned */
+  OSPRAY_INTERFACE float ospWait(OSPFuture);
+
+  //! ask an asynchronously rendered frame to stop early
+  /*! No new tiles will get scheduled; tiles that are already being
+    rendered will still complete, and ospWait() still has to be used
+    to wait for that. Tiles that did not get rendered keep their
+    content of the previous frame. With the MPI device the worker
+    ranks are told to stop as well; frames that composite the tiles
+    of several ranks (data-parallel rendering) still render all
+    tiles. */
+  OSPRAY_INTERFACE void ospCancel(OSPFuture);
+
+  //! returns the fraction [0..1] of tiles of the given frame that are done
+  OSPRAY_INTERFACE float ospGetProgress(OSPFuture);
+
+  //! query how long each tile of the last frame took to render (diagnostics)
+  /*! Returns the number of tiles, and stores the number of tiles in x
+    and y in 'numTilesX'/'numTilesY' (if not NULL). If 'times' is not
+    NULL it has to hold that many floats, and gets filled with the
+    render time of each tile in seconds, row by row; tiles that were
+    skipped (e.g., because they had converged) report 0. The same
+    timings are used to render the most expensive tiles of the next
+    frame first. */
+  OSPRAY_INTERFACE int ospGetTileTimes(OSPFrameBuffer, float *times,
+                                       int *numTilesX OSP_DEFAULT_VAL(=NULL),
+                                       int *numTilesY OSP_DEFAULT_VAL(=NULL));
+
   //! create a new renderer of given type
   /*! return 'NULL' if that type is not known */
   OSPRAY_INTERFACE OSPRenderer ospNewRenderer(const char *type);
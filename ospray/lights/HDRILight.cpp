@@ -24,6 +24,7 @@ namespace ospray {
     , dir(0.f, 0.f, 1.f)
     , map(NULL)
     , intensity(1.f)
+    , aliasSampling(true)
   {
     ispcEquivalent = ispc::HDRILight_create();
   }
@@ -41,6 +42,7 @@ namespace ospray {
     dir = getParam3f("dir", vec3f(0.f, 0.f, 1.f));
     intensity = getParam1f("intensity", 1.f);
     map  = (Texture2D*)getParamObject("map", NULL);
+    aliasSampling = getParam1i("aliasSampling", 1);
 
     linear3f frame;
     frame.vx = normalize(-dir);
@@ -51,7 +53,8 @@ namespace ospray {
         getIE(),
         (const ispc::LinearSpace3f&)frame,
         map ? map->getIE() : NULL,
-        intensity);
+        intensity,
+        aliasSampling);
   }
 
   OSP_REGISTER_LIGHT(HDRILight, hdri);
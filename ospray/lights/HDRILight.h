@@ -43,6 +43,7 @@ namespace ospray {
 //      bool  mirror;             //!< TODO whether to mirror the map
       Texture2D *map;           //!< environment map in latitude / longitude format
       float intensity;          //!< Amount of light emitted
+      bool aliasSampling;       //!< sample the map via alias tables instead of searching its CDFs
   };
 
 }
@@ -30,6 +30,11 @@ namespace ospray {
 
     //! toString is used to aid in printf debugging
     virtual std::string toString() const { return "ospray::Light"; }
+
+    /*! estimate of the emitted power, for selecting lights by
+        importance; lights at infinity return inf, they are sampled at
+        every path vertex */
+    virtual float getPower() const { return inf; }
   };
 
 #define OSP_REGISTER_LIGHT(InternalClassName, external_name)        \
@@ -17,6 +17,11 @@
 #include "PointLight.h"
 #include "PointLight_ispc.h"
 
+#ifdef _WIN32
+#  define _USE_MATH_DEFINES
+#  include <math.h> // M_PI
+#endif
+
 namespace ospray {
   PointLight::PointLight()
     : position(0.f)
@@ -39,6 +44,12 @@ namespace ospray {
     ispc::PointLight_set(getIE(), (ispc::vec3f&)position, (ispc::vec3f&)power, radius);
   }
 
+  float PointLight::getPower() const
+  {
+    // emits into the full sphere
+    return 4.f * float(M_PI) * intensity * reduce_add(color) / 3.f;
+  }
+
   OSP_REGISTER_LIGHT(PointLight, PointLight);
   OSP_REGISTER_LIGHT(PointLight, point);
   OSP_REGISTER_LIGHT(PointLight, SphereLight);
@@ -31,6 +31,9 @@ namespace ospray {
       //! Copy understood parameters into member parameters
       virtual void commit();
 
+      //! Estimate of the emitted power
+      virtual float getPower() const;
+
     private:
       vec3f position;               //!< world-space position of the light
       vec3f color;                  //!< RGB color of the light
@@ -52,6 +52,13 @@ namespace ospray {
                         (ispc::vec3f&)radiance);
   }
 
+  float QuadLight::getPower() const
+  {
+    // one-sided Lambertian emitter
+    const float area = length(cross(edge1, edge2));
+    return float(M_PI) * area * intensity * reduce_add(color) / 3.f;
+  }
+
   OSP_REGISTER_LIGHT(QuadLight, QuadLight);
   OSP_REGISTER_LIGHT(QuadLight, quad); // actually a parallelogram
 }
@@ -65,6 +65,14 @@ namespace ospray {
                         radius);
   }
 
+  float SpotLight::getPower() const
+  {
+    // solid angle of the cone, up to the middle of the penumbra
+    const float cosAngle = cos(deg2rad(0.5f*openingAngle - 0.5f*penumbraAngle));
+    return 2.f * float(M_PI) * (1.f - cosAngle) * intensity
+           * reduce_add(color) / 3.f;
+  }
+
   OSP_REGISTER_LIGHT(SpotLight, SpotLight);
   OSP_REGISTER_LIGHT(SpotLight, ExtendedSpotLight);
   OSP_REGISTER_LIGHT(SpotLight, spot);
@@ -32,6 +32,9 @@ namespace ospray {
       //! Copy understood parameters into class members
       virtual void commit();
 
+      //! Estimate of the emitted power
+      virtual float getPower() const;
+
     private:
       vec3f position;         //!< world-space position of the light
       vec3f direction;        //!< Direction that the SpotLight is pointing
@@ -18,6 +18,7 @@
 
 #include "MPICommon.h"
 #include "ospray/common/ObjectHandle.h"
+#include "mpi/buffers.h"
 
 namespace ospray {
   namespace mpi {
@@ -34,103 +35,78 @@ namespace ospray {
       those parameters, into a wrapper class. allows for implementing
       the actual communication via different methods (MPI, sockets,
       COI) as well as tweaking the implementation in a way that will
-      apply equally to all functions */
+      apply equally to all functions
+
+      On the master side, commands and their (small) arguments are
+      serialized into a local write buffer, and only get broadcast to
+      the workers - as one single batch - when flush() gets called
+      (which the device does for every command that needs the workers
+      to be in sync with the master, such as commit, render, or
+      anything that expects a reply). On the worker side, the get_*()
+      functions decode from the last received batch, and receive the
+      next batch once the current one has been fully consumed.
+
+      Data blocks larger than maxInlineDataSize do not get copied into
+      the batch; instead, the pending batch gets flushed, and the data
+      block gets broadcast directly from the user's memory. Since both
+      sides know the size of each data block this decision is
+      deterministic, and the worker can simply do the same. */
     struct CommandStream {
+      /*! data blocks of this size or larger get sent as separate
+          broadcast rather than being copied into the batch */
+      static const size_t maxInlineDataSize = 256*1024;
+      /*! once a batch grows beyond this size it gets sent even if no
+          flush() was requested, so batches stay bounded */
+      static const size_t maxBatchSize = 4*1024*1024;
+
+      CommandStream() : inReserved(0) {}
+
       void newCommand(int tag) {
-        int rc = MPI_Bcast(&tag,1,MPI_INT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
+        if (out.size >= maxBatchSize)
+          flush();
+        send((int32)tag);
       }
       inline void send(const void *data, const size_t size)
       {
         Assert(data);
-        int rc = MPI_Bcast((void*)data,size,MPI_BYTE,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
+        if (size < maxInlineDataSize) {
+          out.write(data,size);
+        } else {
+          flush();
+          int rc = MPI_Bcast((void*)data,size,MPI_BYTE,MPI_ROOT,mpi::worker.comm);
+          checkMpiError(rc);
+        }
       }
       inline void send(const void *data, const size_t size, int32 rank, const MPI_Comm &comm)
       {
         int rc = MPI_Send((void*)data,size,MPI_BYTE,rank,0,comm);
         checkMpiError(rc);
       }
-      inline void send(int32 i)
-      {
-        int rc = MPI_Bcast(&i,1,MPI_INT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(size_t i)
-      {
-        int rc = MPI_Bcast(&i,1,MPI_AINT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(const vec2f &v)
-      {
-        int rc = MPI_Bcast((void*)&v,2,MPI_FLOAT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(const vec2i &v)
-      {
-        int rc = MPI_Bcast((void*)&v,2,MPI_INT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(const vec3f &v)
-      {
-        int rc = MPI_Bcast((void*)&v,3,MPI_FLOAT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(const vec3i &v)
-      {
-        int rc = MPI_Bcast((void*)&v,3,MPI_INT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(const vec4f &v)
-      {
-        int rc = MPI_Bcast((void*)&v,4,MPI_FLOAT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(uint32 i)
-      {
-        int rc = MPI_Bcast(&i,1,MPI_INT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(const ObjectHandle &h)
-      {
-        int rc = MPI_Bcast((void*)&h,2,MPI_INT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(float f)
-      {
-        int rc = MPI_Bcast(&f,1,MPI_FLOAT,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
-      inline void send(const char *s)
-      {
-        int len = strlen(s);
-        send(len);
-        int rc = MPI_Bcast((void*)s,len,MPI_CHAR,MPI_ROOT,mpi::worker.comm);
-        checkMpiError(rc);
-      }
+      inline void send(int32 i)           { out.write(i); }
+      inline void send(size_t i)          { out.write(i); }
+      inline void send(const vec2f &v)    { out.write(v); }
+      inline void send(const vec2i &v)    { out.write(v); }
+      inline void send(const vec3f &v)    { out.write(v); }
+      inline void send(const vec3i &v)    { out.write(v); }
+      inline void send(const vec4f &v)    { out.write(v); }
+      inline void send(uint32 i)          { out.write(i); }
+      inline void send(const ObjectHandle &h) { out.write(h); }
+      inline void send(float f)           { out.write(f); }
+      inline void send(const char *s)     { out.write<const char *>(s); }
 
-      inline int32 get_int32()
-      {
-        int32 v;
-        int rc = MPI_Bcast(&v,1,MPI_INT,0,mpi::app.comm);
-        checkMpiError(rc);
-        return v;
-      }
-      inline size_t get_size_t()
-      {
-        size_t v;
-        int rc = MPI_Bcast(&v,1,MPI_AINT,0,mpi::app.comm);
-        checkMpiError(rc);
-        return v;
-      }
+      inline int32 get_int32()      { return read<int32>(); }
+      inline size_t get_size_t()    { return read<size_t>(); }
       inline void get_data(size_t size, void *pointer)
       {
-        // int64 size;
-        // int rc = MPI_Bcast(&size,1,MPI_LONG,0,mpi::app.comm);
-        // checkMpiError(rc);
-        int rc = MPI_Bcast(pointer,size,MPI_BYTE,0,mpi::app.comm);
-        // std::cout << "after broadcast!" << std::endl << std::flush; fflush(0);
-        checkMpiError(rc);
+        if (size < maxInlineDataSize) {
+          readBytes(pointer,size);
+        } else {
+          // the master flushed its batch before sending this block,
+          // so we must have consumed everything we received so far
+          Assert(in.next == in.size);
+          int rc = MPI_Bcast(pointer,size,MPI_BYTE,0,mpi::app.comm);
+          checkMpiError(rc);
+        }
       }
       inline void get_data(size_t size, void *pointer, const int32 &rank, const MPI_Comm &comm)
       {
@@ -138,73 +114,66 @@ namespace ospray {
         int rc = MPI_Recv(pointer,size,MPI_BYTE,rank,0,comm,&status);
         checkMpiError(rc);
       }
-      inline ObjectHandle get_handle()
-      {
-        ObjectHandle v;
-        int rc = MPI_Bcast(&v,2,MPI_INT,0,mpi::app.comm);
-        checkMpiError(rc);
-        return v;
-      }
-      inline vec2i get_vec2i()
-      {
-        vec2i v;
-        int rc = MPI_Bcast(&v,2,MPI_INT,0,mpi::app.comm);
-        checkMpiError(rc);
-        return v;
-      }
-      inline vec2f get_vec2f()
-      {
-        vec2f v;
-        int rc = MPI_Bcast(&v,2,MPI_FLOAT,0,mpi::app.comm);
-        checkMpiError(rc);
-        return v;
-      }
-      inline vec3f get_vec3f()
+      inline ObjectHandle get_handle() { return read<ObjectHandle>(); }
+      inline vec2i get_vec2i()      { return read<vec2i>(); }
+      inline vec2f get_vec2f()      { return read<vec2f>(); }
+      inline vec3f get_vec3f()      { return read<vec3f>(); }
+      inline vec4f get_vec4f()      { return read<vec4f>(); }
+      inline vec3i get_vec3i()      { return read<vec3i>(); }
+      inline float get_float()      { return read<float>(); }
+      inline int get_int()          { return read<int>(); }
+      inline void free(const char *s)
+      { Assert(s); ::free((void*)s); }
+      inline const char *get_charPtr()
       {
-        vec3f v;
-        int rc = MPI_Bcast(&v,3,MPI_FLOAT,0,mpi::app.comm);
-        checkMpiError(rc);
-        return v;
+        receiveIfEmpty();
+        return in.read<const char *>();
       }
-      inline vec4f get_vec4f()
+
+      /*! send all commands written since the last flush to the
+          workers, as a single batch. no-op if nothing is pending
+          (which is always the case on the worker side) */
+      void flush()
       {
-        vec4f v;
-        int rc = MPI_Bcast(&v,4,MPI_FLOAT,0,mpi::app.comm);
+        if (out.size == 0) return;
+        int rc = MPI_Bcast(&out.size,1,MPI_AINT,MPI_ROOT,mpi::worker.comm);
         checkMpiError(rc);
-        return v;
-      }
-      inline vec3i get_vec3i()
-      {
-        vec3i v;
-        int rc = MPI_Bcast(&v,3,MPI_INT,0,mpi::app.comm);
+        rc = MPI_Bcast(out.mem,out.size,MPI_BYTE,MPI_ROOT,mpi::worker.comm);
         checkMpiError(rc);
-        return v;
+        out.size = 0;
       }
-      inline float get_float()
+
+    private:
+      /*! receive the next batch from the master if all of the
+          current one has been decoded */
+      void receiveIfEmpty()
       {
-        float v;
-        int rc = MPI_Bcast(&v,1,MPI_FLOAT,0,mpi::app.comm);
+        if (in.next < in.size) return;
+        size_t batchSize = 0;
+        int rc = MPI_Bcast(&batchSize,1,MPI_AINT,0,mpi::app.comm);
         checkMpiError(rc);
-        return v;
-      }
-      inline int get_int()
-      {
-        int v;
-        int rc = MPI_Bcast(&v,1,MPI_INT,0,mpi::app.comm);
+        if (batchSize > inReserved) {
+          in.mem = (unsigned char *)realloc(in.mem,batchSize);
+          in.mine = true;
+          inReserved = batchSize;
+        }
+        rc = MPI_Bcast(in.mem,batchSize,MPI_BYTE,0,mpi::app.comm);
         checkMpiError(rc);
-        return v;
+        in.size = batchSize;
+        in.next = 0;
       }
-      inline void free(const char *s)
-      { Assert(s); ::free((void*)s); }
-      inline const char *get_charPtr()
+      inline void readBytes(void *pointer, size_t size)
       {
-        int len = get_int32();
-        char* buf = (char*)malloc(len+1); buf[len] = 0;
-        int rc = MPI_Bcast(buf,len,MPI_CHAR,0,mpi::app.comm);
-        checkMpiError(rc);
-        return buf;
+        if (size == 0) return;
+        receiveIfEmpty();
+        in.read(pointer,size);
       }
-      void flush() {};
+      template<typename T> inline T read()
+      { T t; readBytes(&t,sizeof(t)); return t; }
+
+      nwlayer::WriteBuffer out; /*!< pending commands (master side) */
+      nwlayer::ReadBuffer  in;  /*!< last received batch (worker side) */
+      size_t inReserved;        /*!< allocated size of 'in.mem' */
     };
 
   } // ::ospray::mpi
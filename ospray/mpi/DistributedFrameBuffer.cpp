@@ -17,6 +17,7 @@
 #include "DistributedFrameBuffer.h"
 #include "DistributedFrameBuffer_TileTypes.h"
 #include "DistributedFrameBuffer_ispc.h"
+#include "TileCompression.h"
 
 #include "common/tasking/async.h"
 #include "common/tasking/parallel_for.h"
@@ -41,8 +42,8 @@ namespace ospray {
     float error;
   };
 
-  /*! message sent to the master when a tile is finished. Todo:
-      compress the color data */
+  /*! message sent to the master when a tile is finished (see
+      CompressedMasterTileMessage for the compressed variant) */
   template <typename FBType>
   struct MasterTileMessage_FB : public MasterTileMessage {
     FBType color[TILE_SIZE][TILE_SIZE];
@@ -55,11 +56,40 @@ namespace ospray {
   /*! message sent from one node's instance to another, to tell that
       instance to write that tile */
   struct WriteTileMessage : public mpi::async::CommLayer::Message {
-    // TODO: add compression of pixels during transmission
     vec2i coords; // XXX redundant: it's also in tile.region.lower
     ospray::Tile tile;
   };
 
+  /*! message sent to the owner of a tile that did not get rendered */
+  struct SkipTileMessage : public mpi::async::CommLayer::Message {
+    vec2i coords;
+  };
+
+  /*! message sent from the master to the workers to cancel a frame */
+  struct CancelFrameMessage : public mpi::async::CommLayer::Message {
+    int32 frameID;
+  };
+
+  /*! compressed variant of MasterTileMessage_FB; the header is
+      followed by 'numBytes' of compressed color data */
+  struct CompressedMasterTileMessage : public MasterTileMessage {
+    uint32 numBytes;
+  };
+
+  //! bytes of pixel data (r,g,b,a,z) at the start of an ospray::Tile
+  static const size_t tilePixelBytes = 5*TILE_SIZE*TILE_SIZE*sizeof(float);
+  static_assert(offsetof(ospray::Tile, region) == tilePixelBytes,
+                "ospray::Tile has to start with its pixel data");
+
+  /*! compressed variant of WriteTileMessage; the header is followed
+      by 'numBytes' of compressed pixel data of the tile */
+  struct CompressedWriteTileMessage : public mpi::async::CommLayer::Message {
+    vec2i coords;
+    //! the non-pixel members of the tile (region, accumID, ...)
+    uint8 tileInfo[sizeof(ospray::Tile) - tilePixelBytes];
+    uint32 numBytes;
+  };
+
   /*! color buffer and depth buffer on master */
 
   enum {
@@ -82,6 +112,17 @@ namespace ospray {
         does not actually care about the pixel data - we still have
         to let the master know when we're done. */
     MASTER_WRITE_TILE_NONE,
+    /*! same as the respective commands above, with the pixel data
+        compressed (see TileCompression.h) */
+    WORKER_WRITE_TILE_COMPRESSED,
+    MASTER_WRITE_TILE_I8_COMPRESSED,
+    MASTER_WRITE_TILE_F32_COMPRESSED,
+    /*! command tag used for telling a tile's owner that the tile will
+        not get rendered this frame, because the frame got cancelled */
+    WORKER_SKIP_TILE,
+    /*! command tag used by the master to tell the workers to stop
+        rendering the current frame (see ospCancel()) */
+    WORKER_CANCEL_FRAME,
   } COMMANDTAG;
 
   // Helper functions /////////////////////////////////////////////////////////
@@ -104,9 +145,18 @@ namespace ospray {
       tileErrorBuffer(nullptr),
       localFBonMaster(nullptr),
       frameMode(WRITE_ONCE),
+      frameID(0),
+      numFramesIssued(0),
+      cancelledFrameID(0),
       frameIsActive(false),
-      frameIsDone(false)
+      frameIsDone(false),
+      tileBytesSent(0),
+      tileBytesUncompressed(0)
   {
+    auto OSPRAY_DFB_COMPRESSION = getEnvVar<int>("OSPRAY_DFB_COMPRESSION");
+    compressTiles = !OSPRAY_DFB_COMPRESSION.first
+                    || OSPRAY_DFB_COMPRESSION.second != 0;
+
     assert(comm);
     this->ispcEquivalent = ispc::DFB_create(this);
     ispc::DFB_set(getIE(), numPixels.x, numPixels.y, colorBufferFormat);
@@ -164,9 +214,16 @@ namespace ospray {
       this->delayedMessage.clear();
       numTilesCompletedThisFrame = 0;
       numTilesToMasterThisFrame = 0;
+      tileBytesSent = 0;
+      tileBytesUncompressed = 0;
 
       frameIsDone   = false;
 
+      // apply a cancel that arrived before this frame started here
+      frameID++;
+      if (frameID == cancelledFrameID)
+        cancelFrame();
+
       // set frame to active - this HAS TO BE the last thing we do
       // before unlockign the mutex, because the 'incoming()' message
       // will actually NOT lock the mutex when checking if
@@ -292,11 +349,84 @@ namespace ospray {
   void DFB::processMessage(WriteTileMessage *msg)
   {
     auto *tileDesc = this->getTileDescFor(msg->coords);
-    // TODO: compress/decompress tile data
     TileData *td = (TileData*)tileDesc;
     td->process(msg->tile);
   }
 
+  void DFB::processMessage(SkipTileMessage *msg)
+  {
+    auto *tileDesc = this->getTileDescFor(msg->coords);
+    TileData *td = (TileData*)tileDesc;
+    td->skip();
+  }
+
+  void DFB::processMessage(CompressedMasterTileMessage *msg)
+  {
+    if (msg->command == MASTER_WRITE_TILE_I8_COMPRESSED) {
+      MasterTileMessage_RGBA_I8 tile;
+      tile.coords = msg->coords;
+      tile.error  = msg->error;
+      mpi::decompressWords(msg+1, msg->numBytes,
+                           tile.color, TILE_SIZE*TILE_SIZE);
+      processMessage(&tile);
+    } else {
+      std::unique_ptr<MasterTileMessage_RGBA_F32> tile
+        (new MasterTileMessage_RGBA_F32);
+      tile->coords = msg->coords;
+      tile->error  = msg->error;
+      mpi::decompressWords(msg+1, msg->numBytes,
+                           tile->color, 4*TILE_SIZE*TILE_SIZE);
+      processMessage(tile.get());
+    }
+  }
+
+  void DFB::processMessage(CompressedWriteTileMessage *msg)
+  {
+    ospray::Tile __aligned(64) tile;
+    mpi::decompressWords(msg+1, msg->numBytes,
+                         &tile, tilePixelBytes/sizeof(float));
+    memcpy((uint8*)&tile + tilePixelBytes, msg->tileInfo,
+           sizeof(msg->tileInfo));
+
+    auto *tileDesc = this->getTileDescFor(msg->coords);
+    TileData *td = (TileData*)tileDesc;
+    td->process(tile);
+  }
+
+  bool DFB::sendCompressedToMaster(TileData *tile, int64 command,
+                                   const void *color, size_t numBytes)
+  {
+    if (!compressTiles)
+      return false;
+
+    auto *mtm = (CompressedMasterTileMessage*)
+      malloc(sizeof(CompressedMasterTileMessage) + numBytes);
+    // NOTE: only send compressed if that's smaller than the raw message
+    const size_t compressedBytes =
+      mpi::compressWords(color, numBytes/sizeof(uint32), mtm+1,
+                         numBytes - sizeof(CompressedMasterTileMessage)
+                                  + sizeof(MasterTileMessage));
+    if (compressedBytes == 0) {
+      free(mtm);
+      return false;
+    }
+
+    mtm->command  = command;
+    mtm->coords   = tile->begin;
+    mtm->error    = tile->error;
+    mtm->numBytes = compressedBytes;
+    const size_t size = sizeof(*mtm) + compressedBytes;
+    countTileBytes(size, sizeof(MasterTileMessage) + numBytes);
+    comm->sendTo(this->master,mtm,size);
+    return true;
+  }
+
+  void DFB::countTileBytes(size_t sent, size_t uncompressed)
+  {
+    tileBytesSent += sent;
+    tileBytesUncompressed += uncompressed;
+  }
+
   void DFB::tileIsCompleted(TileData *tile)
   {
     DBG(printf("rank %i: tilecompleted %i,%i\n",mpi::world.rank,
@@ -307,6 +437,7 @@ namespace ospray {
       {
         SCOPED_LOCK(mutex);
         numTilesCompletedByMyTile = ++numTilesCompletedThisFrame;
+        reportTileDone();
         DBG(printf("MASTER: MARKING AS COMPLETED %i,%i -> %li %i\n",
                    tile->begin.x,tile->begin.y,numTilesCompletedThisFrame,
                    numTiles.x*numTiles.y));
@@ -327,27 +458,38 @@ namespace ospray {
         mtm->command = MASTER_WRITE_TILE_NONE;
         mtm->coords  = tile->begin;
         mtm->error   = tile->error;
+        countTileBytes(sizeof(*mtm), sizeof(*mtm));
         comm->sendTo(this->master,mtm,sizeof(*mtm));
       } break;
       case OSP_FB_RGBA8:
       case OSP_FB_SRGBA: {
         /*! if the master has RGBA8 or SRGBA format, we're sending him a tile
           of the proper data */
+        const size_t numBytes = TILE_SIZE*TILE_SIZE*sizeof(uint32);
+        if (sendCompressedToMaster(tile, MASTER_WRITE_TILE_I8_COMPRESSED,
+                                   tile->color, numBytes))
+          break;
         MasterTileMessage_RGBA_I8 *mtm = new MasterTileMessage_RGBA_I8;
         mtm->command = MASTER_WRITE_TILE_I8;
         mtm->coords  = tile->begin;
         mtm->error   = tile->error;
-        memcpy(mtm->color,tile->color,TILE_SIZE*TILE_SIZE*sizeof(uint32));
+        memcpy(mtm->color,tile->color,numBytes);
+        countTileBytes(sizeof(*mtm), sizeof(*mtm));
         comm->sendTo(this->master,mtm,sizeof(*mtm));
       } break;
       case OSP_FB_RGBA32F: {
         /*! if the master has RGBA32F format, we're sending him a tile of the
           proper data */
+        const size_t numBytes = TILE_SIZE*TILE_SIZE*sizeof(vec4f);
+        if (sendCompressedToMaster(tile, MASTER_WRITE_TILE_F32_COMPRESSED,
+                                   tile->color, numBytes))
+          break;
         MasterTileMessage_RGBA_F32 *mtm = new MasterTileMessage_RGBA_F32;
         mtm->command = MASTER_WRITE_TILE_F32;
         mtm->coords  = tile->begin;
         mtm->error   = tile->error;
-        memcpy(mtm->color,tile->color,TILE_SIZE*TILE_SIZE*sizeof(vec4f));
+        memcpy(mtm->color,tile->color,numBytes);
+        countTileBytes(sizeof(*mtm), sizeof(*mtm));
         comm->sendTo(this->master,mtm,sizeof(*mtm));
       } break;
       default:
@@ -373,6 +515,22 @@ namespace ospray {
 
   void DFB::incoming(mpi::async::CommLayer::Message *_msg)
   {
+    if (_msg->command == WORKER_CANCEL_FRAME) {
+      const int32 cancelID = ((CancelFrameMessage*)_msg)->frameID;
+      delete _msg;
+
+      SCOPED_LOCK(mutex);
+      if (cancelID > frameID) {
+        // the frame did not start here yet, cancel it once it does
+        cancelledFrameID = cancelID;
+      } else if (cancelID == frameID && frameIsActive) {
+        cancelFrame();
+      }
+      // otherwise the cancel is stale (the frame is already done
+      // here) and must not cancel the next one
+      return;
+    }
+
     if (!frameIsActive) {
       SCOPED_LOCK(mutex);
       if (!frameIsActive) {
@@ -397,6 +555,16 @@ namespace ospray {
       case WORKER_WRITE_TILE:
         this->processMessage((WriteTileMessage*)_msg);
         break;
+      case MASTER_WRITE_TILE_I8_COMPRESSED:
+      case MASTER_WRITE_TILE_F32_COMPRESSED:
+        this->processMessage((CompressedMasterTileMessage*)_msg);
+        break;
+      case WORKER_WRITE_TILE_COMPRESSED:
+        this->processMessage((CompressedWriteTileMessage*)_msg);
+        break;
+      case WORKER_SKIP_TILE:
+        this->processMessage((SkipTileMessage*)_msg);
+        break;
       default:
         assert(0);
       };
@@ -416,6 +584,16 @@ namespace ospray {
       if (pixelOp) { 
         pixelOp->endFrame();
       }
+
+      if (logLevel >= 2 && tileBytesSent > 0) {
+        const size_t sent = tileBytesSent;
+        const size_t uncompressed = tileBytesUncompressed;
+        cout << "#osp:mpi:dfb: rank " << comm->group->rank << " sent "
+             << sent/(1024.f*1024.f) << " MB of tiles this frame"
+             << " (compression ratio " << uncompressed/float(sent)
+             << ", saved " << (uncompressed-sent)/(1024.f*1024.f) << " MB)"
+             << endl;
+      }
     }
 
     frameDoneCond.notify_all();
@@ -429,12 +607,34 @@ namespace ospray {
 
     if (!tileDesc->mine()) {
       // NOT my tile...
+      if (compressTiles) {
+        auto *msg = (CompressedWriteTileMessage*)
+          malloc(sizeof(CompressedWriteTileMessage) + tilePixelBytes);
+        // NOTE: only send compressed if that's smaller than the raw message
+        const size_t compressedBytes =
+          mpi::compressWords(&tile, tilePixelBytes/sizeof(float), msg+1,
+                             sizeof(WriteTileMessage)
+                             - sizeof(CompressedWriteTileMessage));
+        if (compressedBytes > 0) {
+          msg->command  = WORKER_WRITE_TILE_COMPRESSED;
+          msg->coords   = tile.region.lower;
+          msg->numBytes = compressedBytes;
+          memcpy(msg->tileInfo, (uint8*)&tile + tilePixelBytes,
+                 sizeof(msg->tileInfo));
+          const size_t size = sizeof(*msg) + compressedBytes;
+          countTileBytes(size, sizeof(WriteTileMessage));
+          comm->sendTo(this->worker[tileDesc->ownerID], msg, size);
+          return;
+        }
+        free(msg);
+      }
+
       WriteTileMessage *msg = new WriteTileMessage;
       msg->coords = tile.region.lower;
-      // TODO: compress pixels before sending ...
       memcpy(&msg->tile,&tile,sizeof(ospray::Tile));
       msg->command = WORKER_WRITE_TILE;
 
+      countTileBytes(sizeof(*msg), sizeof(*msg));
       comm->sendTo(this->worker[tileDesc->ownerID], msg,sizeof(*msg));
     } else {
       // this is my tile...
@@ -446,6 +646,38 @@ namespace ospray {
     }
   }
 
+  void DFB::skipTile(const vec2i &coords)
+  {
+    auto *tileDesc = this->getTileDescFor(coords);
+
+    if (!tileDesc->mine()) {
+      SkipTileMessage *msg = (SkipTileMessage*)malloc(sizeof(SkipTileMessage));
+      msg->command = WORKER_SKIP_TILE;
+      msg->coords  = coords;
+      comm->sendTo(this->worker[tileDesc->ownerID], msg, sizeof(*msg));
+    } else {
+      assert(frameIsActive);
+      ((TileData*)tileDesc)->skip();
+    }
+  }
+
+  int32 DFB::issueFrame()
+  {
+    assert(IamTheMaster());
+    return ++numFramesIssued;
+  }
+
+  void DFB::cancelFrameOnWorkers(int32 cancelID)
+  {
+    assert(IamTheMaster());
+    for (int i = 0; i < comm->numWorkers(); i++) {
+      auto *msg = (CancelFrameMessage*)malloc(sizeof(CancelFrameMessage));
+      msg->command = WORKER_CANCEL_FRAME;
+      msg->frameID = cancelID;
+      comm->sendTo(this->worker[i], msg, sizeof(*msg));
+    }
+  }
+
   /*! \brief clear (the specified channels of) this frame buffer
 
     \details for the *distributed* frame buffer, we assume that
@@ -19,6 +19,7 @@
 #include "mpi/async/CommLayer.h"
 #include "fb/LocalFB.h"
 #include "common/Thread.h"
+#include <atomic>
 #include <queue>
 
 namespace ospray {
@@ -32,6 +33,9 @@ namespace ospray {
   template <typename FBType>
   struct MasterTileMessage_FB;
   struct WriteTileMessage;
+  struct CompressedMasterTileMessage;
+  struct CompressedWriteTileMessage;
+  struct SkipTileMessage;
 
   struct DistributedFrameBuffer
     : public mpi::async::CommLayer::Object,
@@ -73,6 +77,22 @@ namespace ospray {
         and wants the (distributed) frame buffer to process it */
     void setTile(ospray::Tile &tile) override;
 
+    /*! loadbalancer calls this instead of setTile() for a tile that
+        it did not render because the frame got cancelled; the tile
+        keeps its content of the previous frame. Only valid in
+        WRITE_ONCE mode */
+    void skipTile(const vec2i &coords);
+
+    /*! called on the master whenever it sends the command to render a
+        new frame; returns the ID the frame gets on the workers (the
+        number of frames rendered so far, counting this one) */
+    int32 issueFrame();
+
+    /*! called on the master: tell all workers to stop rendering the
+        frame with ID 'cancelID' (tiles that are not started yet get
+        skipped), also if that frame has not started there yet */
+    void cancelFrameOnWorkers(int32 cancelID);
+
     void startNewFrame();
     void closeCurrentFrame();
 
@@ -105,6 +125,24 @@ namespace ospray {
     //! process a client-to-client write tile message */
     void processMessage(WriteTileMessage *msg);
 
+    //! process a message for a tile that did not get rendered
+    void processMessage(SkipTileMessage *msg);
+
+    //! process a compressed write tile message at the master
+    void processMessage(CompressedMasterTileMessage *msg);
+
+    //! process a compressed client-to-client write tile message
+    void processMessage(CompressedWriteTileMessage *msg);
+
+    /*! send the final 'color' data of given tile to the master in
+        compressed form; returns false (without sending anything) if
+        compression is disabled or does not pay off */
+    bool sendCompressedToMaster(TileData *tile, int64 command,
+                                const void *color, size_t numBytes);
+
+    //! account for a tile message of given size that got sent
+    void countTileBytes(size_t sent, size_t uncompressed);
+
     // ==================================================================
     // internal helper functions
     // ==================================================================
@@ -180,6 +218,25 @@ namespace ospray {
         object */
     Mutex mutex;
 
+    /*! whether tile pixels sent to other ranks get compressed (on by
+        default, set OSPRAY_DFB_COMPRESSION=0 to disable) */
+    bool compressTiles;
+
+    /*! bytes of tile messages this rank sent this frame, and the bytes
+        they would have needed without compression */
+    std::atomic<size_t> tileBytesSent;
+    std::atomic<size_t> tileBytesUncompressed;
+
+    //! ID of the current (or last) frame, counts the started frames
+    int32 frameID;
+
+    //! on the master: number of frames issued, see issueFrame()
+    int32 numFramesIssued;
+
+    /*! ID of a frame that got cancelled before it started on this
+        rank, it gets cancelled in startNewFrame() */
+    int32 cancelledFrameID;
+
     //! set to true when the frame becomes 'active', and write tile
     //! messages can be consumed.
     bool frameIsActive;
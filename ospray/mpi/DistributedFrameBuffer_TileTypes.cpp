@@ -155,6 +155,12 @@ namespace ospray {
     }
   }
 
+  void TileData::skip()
+  {
+    /* 'final' still holds the previous frame */
+    dfb->tileIsCompleted(this);
+  }
+
   /*! called exactly once at the beginning of each frame */
   void WriteOnlyOnceTile::newFrame()
   {
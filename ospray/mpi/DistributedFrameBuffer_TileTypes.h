@@ -70,6 +70,12 @@ namespace ospray {
         written into / composited into this dfb tile */
     virtual void process(const ospray::Tile &tile) = 0;
 
+    /*! called instead of process() for a tile that did not get
+        rendered because the frame got cancelled; completes the tile
+        with its content of the previous frame. Only meaningful for
+        write-once tiles, composited tiles need all their parts */
+    virtual void skip();
+
     void accumulate(const ospray::Tile &tile);
 
     float error; // estimated variance of this tile
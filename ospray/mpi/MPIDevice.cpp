@@ -23,6 +23,7 @@
 #include "common/Library.h"
 #include "geometry/TriangleMesh.h"
 #include "render/Renderer.h"
+#include "render/RenderTask.h"
 #include "camera/Camera.h"
 #include "volume/Volume.h"
 #include "mpi/MPILoadBalancer.h"
@@ -415,7 +416,6 @@ namespace ospray {
       cmd.send(size);
       cmd.send((int32)mode);
       cmd.send((int32)channels);
-      cmd.flush();
       return (OSPFrameBuffer)(int64)handle;
     }
     
@@ -451,7 +451,6 @@ namespace ospray {
       ObjectHandle handle = ObjectHandle::alloc();
       cmd.newCommand(CMD_NEW_MODEL);
       cmd.send(handle);
-      cmd.flush();
       return (OSPModel)(int64)handle;
     }
     
@@ -475,7 +474,6 @@ namespace ospray {
       cmd.newCommand(CMD_ADD_GEOMETRY);
       cmd.send((const ObjectHandle &)_model);
       cmd.send((const ObjectHandle &)_geometry);
-      cmd.flush();
     }
 
     /*! add a new volume to a model */
@@ -486,7 +484,6 @@ namespace ospray {
       cmd.newCommand(CMD_ADD_VOLUME);
       cmd.send((const ObjectHandle &) _model);
       cmd.send((const ObjectHandle &) _volume);
-      cmd.flush();
     }
 
     /*! create a new data buffer */
@@ -513,7 +510,6 @@ namespace ospray {
           // array entries' refcount here !?
         }
       }
-      cmd.flush();
       return (OSPData)(int64)handle;
     }
         
@@ -538,30 +534,56 @@ namespace ospray {
       Assert(type != OSP_UNKNOWN && "unknown volume voxel type");
       int typeSize = sizeOf(type);
 
-      size_t size =
-          typeSize * size_t(count.x) * size_t(count.y) * size_t(count.z);
-      // This size restriction is imposed by MPI_Bcast which indexes into the
-      // buffer with an int
-      // limiting us to a max size of 2^31 bytes, a bit more than 2GB
-      if (size > 2000000000LL) {
-        throw std::runtime_error("setregion does not currently work for "
-                                 "region sizes > 2GB");
+      // Send the region as a sequence of sub-regions, each small enough to
+      // fit the workers' staging buffer (and far below the 2GB an int-indexed
+      // MPI_Bcast can handle). Whole z-slices are sent where they fit, rows of
+      // a single slice otherwise. The sub-regions are broadcast straight from
+      // the application's memory, and the per-chunk replies are only
+      // collected once all chunks are on their way, so the workers can
+      // copy one chunk while the next one is in flight.
+      const size_t maxChunkSize = 32*1024*1024;
+      const size_t rowSize   = typeSize * size_t(count.x);
+      const size_t sliceSize = rowSize * size_t(count.y);
+
+      vec3i chunkCount = count;
+      if (sliceSize <= maxChunkSize) {
+        chunkCount.z = std::max(size_t(1), maxChunkSize / std::max(sliceSize, size_t(1)));
+      } else {
+        chunkCount.y = std::max(size_t(1), maxChunkSize / rowSize);
+        chunkCount.z = 1;
       }
 
-      cmd.newCommand(CMD_SET_REGION);
-      cmd.send((const ObjectHandle &)_volume);
-      cmd.send(index);
-      cmd.send(count);
-      cmd.send(size);
-      cmd.send(source,size);
-      cmd.flush();
+      int numChunks = 0;
+      for (int z = 0; z < count.z; z += chunkCount.z) {
+        for (int y = 0; y < count.y; y += chunkCount.y) {
+          const vec3i chunkIndex(0, y, z);
+          const vec3i thisCount(count.x,
+                                std::min(chunkCount.y, count.y - y),
+                                std::min(chunkCount.z, count.z - z));
+          const size_t size = rowSize * size_t(thisCount.y) * size_t(thisCount.z);
+          const char *chunk = (const char *)source
+            + rowSize * (size_t(y) + size_t(count.y) * size_t(z));
+
+          cmd.newCommand(CMD_SET_REGION);
+          cmd.send((const ObjectHandle &)_volume);
+          cmd.send(index + chunkIndex);
+          cmd.send(thisCount);
+          cmd.send(size);
+          cmd.send(chunk,size);
+          cmd.flush();
+          numChunks++;
+        }
+      }
 
       int numFails = 0;
-      MPI_Status status;
-      int rc = MPI_Recv(&numFails,1,MPI_INT,
-                        0,MPI_ANY_TAG,mpi::worker.comm,&status);
-
-      Assert(rc == MPI_SUCCESS);
+      for (int i = 0; i < numChunks; i++) {
+        int chunkFails = 0;
+        MPI_Status status;
+        int rc = MPI_Recv(&chunkFails,1,MPI_INT,
+                          0,MPI_ANY_TAG,mpi::worker.comm,&status);
+        Assert(rc == MPI_SUCCESS);
+        numFails += chunkFails;
+      }
 
       return (numFails == 0);
     }
@@ -717,7 +739,6 @@ namespace ospray {
       cmd.send(tgtObjectHandle);
       cmd.send(bufName);
       cmd.send(valObjectHandle);
-      cmd.flush();
     }
 
     /*! create a new pixelOp object (out of list of registered pixelOps) */
@@ -730,7 +751,6 @@ namespace ospray {
       cmd.newCommand(CMD_NEW_PIXELOP);
       cmd.send(handle);
       cmd.send(type);
-      cmd.flush();
       return (OSPPixelOp)(int64)handle;
     }
 
@@ -743,7 +763,6 @@ namespace ospray {
       cmd.newCommand(CMD_SET_PIXELOP);
       cmd.send((const ObjectHandle&)_fb);
       cmd.send((const ObjectHandle&)_op);
-      cmd.flush();
     }
       
     /*! create a new renderer object (out of list of registered renderers) */
@@ -756,7 +775,6 @@ namespace ospray {
       cmd.newCommand(CMD_NEW_RENDERER);
       cmd.send(handle);
       cmd.send(type);
-      cmd.flush();
       return (OSPRenderer)(int64)handle;
     }
 
@@ -770,7 +788,6 @@ namespace ospray {
       cmd.newCommand(CMD_NEW_CAMERA);
       cmd.send(handle);
       cmd.send(type);
-      cmd.flush();
       return (OSPCamera)(int64)handle;
     }
 
@@ -784,7 +801,6 @@ namespace ospray {
       cmd.newCommand(CMD_NEW_VOLUME);
       cmd.send(handle);
       cmd.send(type);
-      cmd.flush();
       return (OSPVolume)(int64)handle;
     }
 
@@ -798,7 +814,6 @@ namespace ospray {
       cmd.newCommand(CMD_NEW_GEOMETRY);
       cmd.send((const ObjectHandle&)handle);
       cmd.send(type);
-      cmd.flush();
       return (OSPGeometry)(int64)handle;
     }
     
@@ -843,7 +858,6 @@ namespace ospray {
       cmd.newCommand(CMD_NEW_TRANSFERFUNCTION);
       cmd.send(handle);
       cmd.send(type);
-      cmd.flush();
       return (OSPTransferFunction)(int64)handle;
     }
 
@@ -896,7 +910,6 @@ namespace ospray {
       cmd.newCommand(CMD_FRAMEBUFFER_CLEAR);
       cmd.send(handle);
       cmd.send((int32)fbChannelFlags);
-      cmd.flush();
 
       // also clear FB on master, i.e. clear error buffer for variance
       // estimation
@@ -910,7 +923,6 @@ namespace ospray {
       cmd.newCommand(CMD_REMOVE_GEOMETRY);
       cmd.send((const ObjectHandle&)_model);
       cmd.send((const ObjectHandle&)_geometry);
-      cmd.flush();
     }
 
     /*! remove an existing volume from a model */
@@ -919,7 +931,6 @@ namespace ospray {
       cmd.newCommand(CMD_REMOVE_VOLUME);
       cmd.send((const ObjectHandle&)_model);
       cmd.send((const ObjectHandle&)_volume);
-      cmd.flush();
     }
 
 
@@ -936,6 +947,14 @@ namespace ospray {
 
       //FrameBuffer *fb = sc->getFrontBuffer();
       // FrameBuffer *fb = sc->getBackBuffer();
+      fb->beginFrameProgress();
+
+      // NOTE: keep the frame count in sync with the workers', it
+      //       identifies the frame an ospCancel() is meant for
+      auto *dfb = dynamic_cast<DistributedFrameBuffer*>(fb);
+      if (dfb)
+        dfb->issueFrame();
+
       cmd.newCommand(CMD_RENDER_FRAME);
       cmd.send((const ObjectHandle&)_fb);
       cmd.send((const ObjectHandle&)_renderer);
@@ -945,6 +964,82 @@ namespace ospray {
       return TiledLoadBalancer::instance->renderFrame(NULL,fb,fbChannelFlags);
     }
 
+    /*! call a renderer to render a frame buffer, without waiting for it */
+    OSPFuture MPIDevice::renderFrameAsync(OSPFrameBuffer _fb,
+                                          OSPRenderer _renderer,
+                                          const uint32 fbChannelFlags)
+    {
+      const ObjectHandle handle = (const ObjectHandle&)_fb;
+      FrameBuffer *fb = (FrameBuffer *)handle.lookup();
+
+      // NOTE: the future only lives on the master, the workers never
+      //       see its handle
+      RenderTask *task = new RenderTask(fb, nullptr);
+      ObjectHandle futureHandle = ObjectHandle::alloc();
+      futureHandle.assign(task);
+
+      // NOTE: the master may not even have started the frame when the
+      //       app cancels it, so the frame's ID is taken right here
+      auto *dfb = dynamic_cast<DistributedFrameBuffer*>(fb);
+      if (dfb)
+        task->frameID = dfb->issueFrame();
+
+      // NOTE: the render command itself has to be issued from the
+      //       calling thread, as the command stream must not be used
+      //       concurrently; only waiting for the distributed frame
+      //       buffer is done asynchronously
+      cmd.newCommand(CMD_RENDER_FRAME);
+      cmd.send((const ObjectHandle&)_fb);
+      cmd.send((const ObjectHandle&)_renderer);
+      cmd.send((int32)fbChannelFlags);
+      cmd.flush();
+
+      task->start([=]() {
+        return TiledLoadBalancer::instance->renderFrame(NULL,fb,fbChannelFlags);
+      });
+
+      return (OSPFuture)(int64)futureHandle;
+    }
+
+    bool MPIDevice::isReady(OSPFuture _future)
+    {
+      const ObjectHandle handle = (const ObjectHandle&)_future;
+      RenderTask *task = (RenderTask *)handle.lookup();
+      Assert(task);
+      return task->isFinished();
+    }
+
+    float MPIDevice::wait(OSPFuture _future)
+    {
+      const ObjectHandle handle = (const ObjectHandle&)_future;
+      RenderTask *task = (RenderTask *)handle.lookup();
+      Assert(task);
+      return task->wait();
+    }
+
+    void MPIDevice::cancel(OSPFuture _future)
+    {
+      const ObjectHandle handle = (const ObjectHandle&)_future;
+      RenderTask *task = (RenderTask *)handle.lookup();
+      Assert(task);
+      task->cancel();
+
+      // NOTE: the worker ranks are busy rendering and only see new
+      //       commands once the frame is done, so the cancel goes
+      //       through the frame buffer's own messaging instead
+      auto *dfb = dynamic_cast<DistributedFrameBuffer*>(task->fb.ptr);
+      if (dfb)
+        dfb->cancelFrameOnWorkers(task->frameID);
+    }
+
+    float MPIDevice::getProgress(OSPFuture _future)
+    {
+      const ObjectHandle handle = (const ObjectHandle&)_future;
+      RenderTask *task = (RenderTask *)handle.lookup();
+      Assert(task);
+      return task->getProgress();
+    }
+
     //! release (i.e., reduce refcount of) given object
     /*! note that all objects in ospray are refcounted, so one cannot
       explicitly "delete" any object. instead, each object is created
@@ -958,9 +1053,17 @@ namespace ospray {
     void MPIDevice::release(OSPObject _obj)
     {
       if (!_obj) return;
+
+      // futures only exist on the master
+      ObjectHandle handle = (const ObjectHandle&)_obj;
+      if (handle.defined() && dynamic_cast<RenderTask*>(handle.lookup())) {
+        handle.freeObject();
+        handle.free();
+        return;
+      }
+
       cmd.newCommand(CMD_RELEASE);
       cmd.send((const ObjectHandle&)_obj);
-      cmd.flush();
     }
 
     //! assign given material to given geometry
@@ -969,7 +1072,6 @@ namespace ospray {
       cmd.newCommand(CMD_SET_MATERIAL);
       cmd.send((const ObjectHandle&)_geometry);
       cmd.send((const ObjectHandle&)_material);
-      cmd.flush();
     }
 
     /*! create a new Texture2D object */
@@ -987,7 +1089,6 @@ namespace ospray {
       cmd.send(size);
 
       cmd.send(data,size);
-      cmd.flush();
       return (OSPTexture2D)(int64)handle;
     }
 
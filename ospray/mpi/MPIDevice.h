@@ -175,6 +175,16 @@ namespace ospray {
                                OSPRenderer _renderer, 
                                const uint32 fbChannelFlags) override;
 
+      /*! call a renderer to render a frame buffer, without waiting for it */
+      OSPFuture renderFrameAsync(OSPFrameBuffer _fb,
+                                 OSPRenderer _renderer,
+                                 const uint32 fbChannelFlags) override;
+
+      bool isReady(OSPFuture _future) override;
+      float wait(OSPFuture _future) override;
+      void cancel(OSPFuture _future) override;
+      float getProgress(OSPFuture _future) override;
+
       /*! load module */
       int loadModule(const char *name) override;
 
@@ -66,6 +66,9 @@ namespace ospray {
         async_beginFrame();
 
         auto *dfb = dynamic_cast<DistributedFrameBuffer*>(fb);
+        // reset before the frame gets active, a cancel from the master
+        // may arrive any time after that
+        dfb->beginFrameProgress();
         dfb->startNewFrame();
 
         void *perFrameData = tiledRenderer->beginFrame(fb);
@@ -89,6 +92,14 @@ namespace ospray {
           const vec2i tileId(tile_x, tile_y);
           const int32 accumID = fb->accumID(tileID);
 
+          // composited tiles need the parts of all ranks, so only
+          // write-once frames can skip tiles
+          if (fb->isFrameCancelled()
+              && dfb->frameMode == DistributedFrameBuffer::WRITE_ONCE) {
+            dfb->skipTile(tileId*TILE_SIZE);
+            return;
+          }
+
 #ifdef __MIC__
 #  define MAX_TILE_SIZE 32
 #else
@@ -0,0 +1,312 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#include "RadixKCompositor.h"
+#include "TileCompression.h"
+#include "common/tasking/parallel_for.h"
+
+namespace ospray {
+  namespace mpi {
+
+    //! narrow [begin,end) down to the i'th of 'k' (nearly) equal pieces
+    static inline void splitRange(size_t &begin, size_t &end, int k, int i)
+    {
+      const size_t first = begin;
+      const size_t count = end - begin;
+      begin = first + (count*i)/k;
+      end   = first + (count*(i+1))/k;
+    }
+
+    /*! append all (non-empty) tiles in [begin,end) to 'buffer'; each
+        one as its uint32 tile index, the uint32 number of bytes that
+        follow, and the tile - compressed if that is smaller */
+    static void packTiles(const std::vector<Tile *> &tiles,
+                          size_t begin, size_t end,
+                          std::vector<uint8> &buffer)
+    {
+      const size_t headerSize = 2*sizeof(uint32);
+      size_t numTiles = 0;
+      for (size_t i = begin; i < end; i++)
+        numTiles += (tiles[i] != nullptr);
+
+      buffer.resize(numTiles*(headerSize + sizeof(Tile)));
+      size_t size = 0;
+      for (size_t i = begin; i < end; i++) {
+        if (!tiles[i])
+          continue;
+
+        uint32 *header = (uint32*)&buffer[size];
+        uint8  *data   = &buffer[size+headerSize];
+        size_t numBytes = compressWords(tiles[i], sizeof(Tile)/sizeof(uint32),
+                                        data, sizeof(Tile)-sizeof(uint32));
+        // NOTE: a size of sizeof(Tile) tags an uncompressed tile
+        if (numBytes == 0) {
+          memcpy(data, tiles[i], sizeof(Tile));
+          numBytes = sizeof(Tile);
+        }
+        header[0] = i;
+        header[1] = numBytes;
+        size += headerSize + numBytes;
+      }
+      buffer.resize(size);
+    }
+
+    RadixKCompositor::RadixKCompositor(MPI_Comm comm, Mode mode, int radix)
+      : mode(mode),
+        radix(radix),
+        bytesSent(0)
+    {
+      MPI_CALL(Comm_dup(comm,&this->comm));
+      MPI_CALL(Comm_rank(this->comm,&rank));
+      MPI_CALL(Comm_size(this->comm,&size));
+
+      // factor the number of ranks into rounds of at most 'radix' ranks
+      // each; prime factors larger than that get a round of their own
+      std::vector<int> primes;
+      int n = size;
+      for (int p = 2; p*p <= n; p++) {
+        while (n % p == 0) {
+          primes.push_back(p);
+          n /= p;
+        }
+      }
+      if (n > 1)
+        primes.push_back(n);
+
+      int factor = 1;
+      for (auto p : primes) {
+        if (factor > 1 && factor*p > std::max(radix,2)) {
+          factors.push_back(factor);
+          factor = 1;
+        }
+        factor *= p;
+      }
+      if (factor > 1)
+        factors.push_back(factor);
+    }
+
+    RadixKCompositor::~RadixKCompositor()
+    {
+      int finalized = 0;
+      MPI_Finalized(&finalized);
+      if (!finalized)
+        MPI_Comm_free(&comm);
+    }
+
+    void RadixKCompositor::finalTileRange(int rank, size_t numTiles,
+                                          size_t &begin, size_t &end) const
+    {
+      begin = 0;
+      end   = numTiles;
+      int stride = 1;
+      for (auto k : factors) {
+        splitRange(begin, end, k, (rank / stride) % k);
+        stride *= k;
+      }
+    }
+
+    void RadixKCompositor::composite(std::vector<Tile *> &tiles)
+    {
+      bytesSent = 0;
+
+      size_t begin = 0;
+      size_t end   = tiles.size();
+      int stride   = 1;
+
+      for (auto k : factors) {
+        const int digit     = (rank / stride) % k;
+        const int groupBase = rank - digit*stride;
+
+        std::vector<std::vector<uint8>> sendBuffer(k);
+        std::vector<std::vector<uint8>> recvBuffer(k);
+        std::vector<uint64> sendSize(k, 0);
+        std::vector<uint64> recvSize(k, 0);
+
+        parallel_for(k, [&](int i) {
+          if (i == digit)
+            return;
+          size_t pieceBegin = begin, pieceEnd = end;
+          splitRange(pieceBegin, pieceEnd, k, i);
+          packTiles(tiles, pieceBegin, pieceEnd, sendBuffer[i]);
+          sendSize[i] = sendBuffer[i].size();
+        });
+
+        // exchange the sizes of the pieces, then the pieces themselves
+        std::vector<MPI_Request> request;
+        request.reserve(2*k);
+        for (int i = 0; i < k; i++) {
+          if (i == digit)
+            continue;
+          const int partner = groupBase + i*stride;
+          request.push_back(MPI_REQUEST_NULL);
+          MPI_CALL(Irecv(&recvSize[i], 1, MPI_UINT64_T, partner, 0, comm,
+                         &request.back()));
+          request.push_back(MPI_REQUEST_NULL);
+          MPI_CALL(Isend(&sendSize[i], 1, MPI_UINT64_T, partner, 0, comm,
+                         &request.back()));
+        }
+        MPI_CALL(Waitall(request.size(), request.data(),
+                         MPI_STATUSES_IGNORE));
+
+        request.clear();
+        for (int i = 0; i < k; i++) {
+          if (i == digit)
+            continue;
+          if (sendSize[i] > std::numeric_limits<int>::max() ||
+              recvSize[i] > std::numeric_limits<int>::max()) {
+            throw std::runtime_error("#osp:mpi: radix-k compositing piece "
+                                     "exceeds 2GB");
+          }
+          const int partner = groupBase + i*stride;
+          recvBuffer[i].resize(recvSize[i]);
+          if (recvSize[i] > 0) {
+            request.push_back(MPI_REQUEST_NULL);
+            MPI_CALL(Irecv(recvBuffer[i].data(), recvSize[i], MPI_BYTE,
+                           partner, 1, comm, &request.back()));
+          }
+          if (sendSize[i] > 0) {
+            request.push_back(MPI_REQUEST_NULL);
+            MPI_CALL(Isend(sendBuffer[i].data(), sendSize[i], MPI_BYTE,
+                           partner, 1, comm, &request.back()));
+          }
+          bytesSent += sendSize[i];
+        }
+        MPI_CALL(Waitall(request.size(), request.data(),
+                         MPI_STATUSES_IGNORE));
+
+        // the tiles we handed off to our partners are not needed any more
+        size_t keepBegin = begin, keepEnd = end;
+        splitRange(keepBegin, keepEnd, k, digit);
+        for (size_t i = begin; i < end; i++) {
+          if (i >= keepBegin && i < keepEnd)
+            continue;
+          delete tiles[i];
+          tiles[i] = nullptr;
+        }
+
+        // decode the pieces we received; the tiles of one partner are all
+        // different, so they can be processed in parallel
+        const size_t numKept = keepEnd - keepBegin;
+        std::vector<std::vector<Tile *>> received(k);
+        for (int i = 0; i < k; i++) {
+          if (i == digit || recvBuffer[i].empty())
+            continue;
+
+          std::vector<size_t> offset;
+          for (size_t ofs = 0; ofs < recvBuffer[i].size();) {
+            offset.push_back(ofs);
+            ofs += 2*sizeof(uint32) + ((uint32*)&recvBuffer[i][ofs])[1];
+          }
+
+          received[i].assign(numKept, nullptr);
+          parallel_for(offset.size(), [&](int j) {
+            const uint32 *header = (const uint32*)&recvBuffer[i][offset[j]];
+            const uint8  *data   = (const uint8*)(header + 2);
+            const uint32 tileID  = header[0];
+            const uint32 numBytes = header[1];
+            if (tileID < keepBegin || tileID >= keepEnd)
+              return; // corrupt data, will not happen
+
+            Tile *tile = new Tile;
+            if (numBytes == sizeof(Tile))
+              memcpy(tile, data, sizeof(Tile));
+            else
+              decompressWords(data, numBytes, tile, sizeof(Tile)/sizeof(uint32));
+            received[i][tileID - keepBegin] = tile;
+          });
+        }
+
+        // composite all contributions to each tile we keep at once, so
+        // that fragments are blended in depth order
+        parallel_for(numKept, [&](int j) {
+          Tile *&tile = tiles[keepBegin + j];
+          std::vector<const Tile *> parts;
+          if (tile)
+            parts.push_back(tile);
+          for (int i = 0; i < k; i++) {
+            if (!received[i].empty() && received[i][j])
+              parts.push_back(received[i][j]);
+          }
+
+          if (parts.size() > 1) {
+            if (!tile)
+              tile = (Tile*)parts[0];
+            blend(*tile, parts.data(), parts.size());
+          } else if (parts.size() == 1) {
+            tile = (Tile*)parts[0];
+          }
+
+          for (auto *part : parts) {
+            if (part != tile)
+              delete part;
+          }
+        });
+
+        begin   = keepBegin;
+        end     = keepEnd;
+        stride *= k;
+      }
+    }
+
+    void RadixKCompositor::blend(Tile &dst, const Tile *const *parts,
+                                 int numParts) const
+    {
+      if (mode == Z_COMPOSITE) {
+        for (int i = 0; i < TILE_SIZE*TILE_SIZE; i++) {
+          const Tile *closest = parts[0];
+          for (int p = 1; p < numParts; p++) {
+            if (parts[p]->z[i] < closest->z[i])
+              closest = parts[p];
+          }
+          dst.r[i] = closest->r[i];
+          dst.g[i] = closest->g[i];
+          dst.b[i] = closest->b[i];
+          dst.a[i] = closest->a[i];
+          dst.z[i] = closest->z[i];
+        }
+        return;
+      }
+
+      const Tile **sorted = STACK_BUFFER(const Tile *, numParts);
+      for (int i = 0; i < TILE_SIZE*TILE_SIZE; i++) {
+        // sort the parts front to back ...
+        for (int p = 0; p < numParts; p++) {
+          int j = p;
+          for (; j > 0 && sorted[j-1]->z[i] > parts[p]->z[i]; j--)
+            sorted[j] = sorted[j-1];
+          sorted[j] = parts[p];
+        }
+
+        // ... and blend them with the 'over' operator (premultiplied)
+        float r = 0.f, g = 0.f, b = 0.f, a = 0.f;
+        for (int p = 0; p < numParts; p++) {
+          const float t = 1.f - a;
+          r += t * sorted[p]->r[i];
+          g += t * sorted[p]->g[i];
+          b += t * sorted[p]->b[i];
+          a += t * sorted[p]->a[i];
+        }
+        dst.r[i] = r;
+        dst.g[i] = g;
+        dst.b[i] = b;
+        dst.a[i] = a;
+        dst.z[i] = sorted[0]->z[i];
+      }
+    }
+
+  } // ::ospray::mpi
+} // ::ospray
@@ -0,0 +1,96 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+#include "mpi/MPICommon.h"
+#include "fb/Tile.h"
+
+#include <vector>
+
+/*! \file ospray/mpi/RadixKCompositor.h Scalable sort-last compositing
+  of partial images across the ranks of an MPI communicator */
+
+namespace ospray {
+  namespace mpi {
+
+    /*! \brief composites the partial images of all ranks of a
+        communicator with the radix-k algorithm (binary swap for k=2)
+
+      Every rank contributes (at most) one partial ospray::Tile per
+      tile of the frame. The ranks are split into groups of (up to) k
+      ranks; in each round, the ranks of a group split their current
+      range of tiles into one piece per rank, keep one piece and
+      exchange all others with their partners, so the tiles are
+      composited in log_k(numRanks) rounds with every rank doing an
+      equal share of the work. Afterwards each rank holds the final
+      composite of about 1/numRanks of the tiles (see
+      finalTileRange()).
+
+      Colors are expected to be premultiplied by alpha, and the depth
+      of a partial pixel is the depth of its closest sample. ALPHA_BLEND
+      sorts the (up to k) contributions to a pixel in each round by
+      depth and blends them front to back. This is exact as long as
+      the contributions being blended do not interleave in depth along
+      a pixel ray, i.e., if every rank - and every group of ranks
+      merged in a round (ranks [i*k^r,(i+1)*k^r) after round r) - covers
+      a convex region of space, as with a k-d tree decomposition. */
+    struct RadixKCompositor {
+
+      typedef enum { Z_COMPOSITE, ALPHA_BLEND } Mode;
+
+      /*! creates a compositor for all ranks of 'comm' (which gets
+          duplicated, so compositing does not interfere with other
+          traffic on it); this is a collective operation */
+      RadixKCompositor(MPI_Comm comm, Mode mode, int radix = 2);
+      ~RadixKCompositor();
+
+      /*! \brief composite 'tiles' across all ranks; collective operation
+
+        'tiles' has one entry per tile of the frame (nullptr if this
+        rank does not contribute to that tile), which the compositor
+        takes ownership of. Afterwards the entries in finalTileRange()
+        hold the final results (still nullptr if no rank contributed
+        to a tile), all other entries are deleted and set to nullptr. */
+      void composite(std::vector<Tile *> &tiles);
+
+      /*! the range [begin,end) of tiles that 'rank' holds the final
+          result for, after compositing a frame of 'numTiles' tiles */
+      void finalTileRange(int rank, size_t numTiles,
+                          size_t &begin, size_t &end) const;
+
+      /*! composite the partial tiles 'parts' into 'dst' (which may be
+          one of the parts) */
+      void blend(Tile &dst, const Tile *const *parts, int numParts) const;
+
+      MPI_Comm comm;
+      int      rank;
+      int      size;
+      Mode     mode;
+
+      //! the radix the compositor was created with
+      int      radix;
+
+      //! the number of ranks in a group for each round
+      std::vector<int> factors;
+
+      //! bytes this rank sent in the last call to composite()
+      size_t bytesSent;
+    };
+
+  } // ::ospray::mpi
+} // ::ospray
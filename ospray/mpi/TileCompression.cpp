@@ -0,0 +1,101 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#include "TileCompression.h"
+
+namespace ospray {
+  namespace mpi {
+
+    size_t compressWords(const void *_in, size_t numWords,
+                         void *_out, size_t maxBytes)
+    {
+      const uint32 *in  = (const uint32*)_in;
+      int32        *out = (int32*)_out;
+      const size_t maxWords = maxBytes / sizeof(int32);
+      // the largest run/literal length a control word can hold
+      const size_t maxRun = (1u << 30);
+
+      size_t numOut = 0;
+      size_t i = 0;
+      while (i < numWords) {
+        // length of the run of identical words starting at 'i'
+        size_t run = 1;
+        while (i+run < numWords && run < maxRun && in[i+run] == in[i])
+          run++;
+
+        if (run >= 2) {
+          if (numOut + 2 > maxWords)
+            return 0;
+          out[numOut++] = (int32)run;
+          out[numOut++] = (int32)in[i];
+          i += run;
+          continue;
+        }
+
+        // collect literals until the next run of (at least) 3 words,
+        // shorter runs are cheaper to store as literals
+        size_t end = i+1;
+        while (end < numWords && end-i < maxRun) {
+          if (end+2 < numWords && in[end] == in[end+1] && in[end] == in[end+2])
+            break;
+          end++;
+        }
+
+        const size_t numLiterals = end-i;
+        if (numOut + 1 + numLiterals > maxWords)
+          return 0;
+        out[numOut++] = -(int32)numLiterals;
+        memcpy(out+numOut, in+i, numLiterals*sizeof(uint32));
+        numOut += numLiterals;
+        i = end;
+      }
+      return numOut * sizeof(int32);
+    }
+
+    void decompressWords(const void *_in, size_t numBytes,
+                         void *_out, size_t numWords)
+    {
+      const int32 *in  = (const int32*)_in;
+      uint32      *out = (uint32*)_out;
+      const size_t numIn = numBytes / sizeof(int32);
+
+      size_t i = 0, numOut = 0;
+      while (i < numIn) {
+        const int32 count = in[i++];
+        if (count > 0) {
+          if (i >= numIn || numOut + count > numWords)
+            throw std::runtime_error("#osp:mpi: corrupt compressed tile data");
+          const uint32 value = in[i++];
+          for (int32 j = 0; j < count; j++)
+            out[numOut++] = value;
+        } else {
+          const size_t numLiterals = -(int64)count;
+          if (count == 0 || i + numLiterals > numIn
+              || numOut + numLiterals > numWords)
+            throw std::runtime_error("#osp:mpi: corrupt compressed tile data");
+          memcpy(out+numOut, in+i, numLiterals*sizeof(uint32));
+          i      += numLiterals;
+          numOut += numLiterals;
+        }
+      }
+
+      if (numOut != numWords)
+        throw std::runtime_error("#osp:mpi: corrupt compressed tile data");
+    }
+
+  } // ::ospray::mpi
+} // ::ospray
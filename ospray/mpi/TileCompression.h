@@ -0,0 +1,50 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+#include "common/OSPCommon.h"
+
+/*! \file ospray/mpi/TileCompression.h Lossless compression of tile
+  pixel data sent between the ranks of the distributed frame buffer */
+
+namespace ospray {
+  namespace mpi {
+
+    /*! \brief run-length encode 'numWords' 32-bit words from 'in' into
+        'out'
+
+      The encoded stream is a sequence of int32 control words: a
+      positive count 'n' is followed by a single word that is repeated
+      'n' times, a negative count '-n' is followed by 'n' literal
+      words. This is fast, bit-exact for floats, and collapses the
+      constant background that usually makes up most of a tile.
+
+      \returns the number of bytes written to 'out', or 0 if the
+      encoded data would not fit into 'maxBytes' (in which case the
+      data should be sent uncompressed) */
+    size_t compressWords(const void *in, size_t numWords,
+                         void *out, size_t maxBytes);
+
+    /*! \brief decode 'numBytes' of data produced by compressWords()
+        into exactly 'numWords' 32-bit words; throws if the data is
+        corrupt */
+    void decompressWords(const void *in, size_t numBytes,
+                         void *out, size_t numWords);
+
+  } // ::ospray::mpi
+} // ::ospray
@@ -34,7 +34,7 @@ namespace ospray {
       size_t         next; /*!< next posiiton we're reading from */
       bool           mine;
       inline ReadBuffer() 
-        : mem(NULL), size(0), mine(false) 
+        : mem(NULL), size(0), next(0), mine(false) 
       {}
       inline ReadBuffer(size_t sz) 
         : mem((unsigned char*)malloc(sz)), size(sz), next(0), mine(true)
@@ -0,0 +1,173 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+/*! \file TestCancelFrame.cpp test of ospCancel() with the MPI device,
+  run with e.g.
+
+    mpirun -n 3 ospray_mpi_test_cancel --osp:mpi
+
+  Every round renders a full frame in one color (red or blue), then
+  renders a frame in the other color with ospRenderFrameAsync() and
+  calls ospCancel() right away, i.e. usually before the workers even
+  started that frame. Tiles that did not get rendered keep the color
+  of the previous frame, so the test checks that
+
+  - ospWait() returns for the cancelled frame,
+  - the cancelled frame skipped some tiles (the cancel reached the
+    workers, also if it arrived before their frame started), and
+  - the following full frame renders all tiles (the cancel did not
+    leak into the next frame). */
+
+#include "ospray/ospray.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace ospray {
+
+  static const osp::vec2i imageSize = {1024, 1024};
+  static const int tileSize = 64;
+  static const int numRounds = 10;
+
+  static OSPRenderer    renderer = nullptr;
+  static OSPMaterial    material = nullptr;
+  static OSPFrameBuffer fb       = nullptr;
+
+  /*! an AO-heavy scene filling the whole image: a ground plane covered
+      with spheres, seen from above */
+  void createScene()
+  {
+    renderer = ospNewRenderer("ao");
+
+    material = ospNewMaterial(renderer, "OBJMaterial");
+    ospCommit(material);
+
+    const float vertices[] = { -2.f, 0.f, -2.f,
+                                2.f, 0.f, -2.f,
+                                2.f, 0.f,  2.f,
+                               -2.f, 0.f,  2.f };
+    const int indices[] = { 0, 1, 2,   0, 2, 3 };
+    OSPGeometry ground = ospNewGeometry("triangles");
+    ospSetData(ground, "vertex", ospNewData(4, OSP_FLOAT3, vertices));
+    ospSetData(ground, "index", ospNewData(2, OSP_INT3, indices));
+    ospSetMaterial(ground, material);
+    ospCommit(ground);
+
+    std::vector<float> spheres;
+    for (int z = -10; z < 10; z++)
+      for (int x = -10; x < 10; x++) {
+        spheres.push_back(0.1f * x + 0.05f);
+        spheres.push_back(0.f);
+        spheres.push_back(0.1f * z + 0.05f);
+      }
+    OSPGeometry occluders = ospNewGeometry("spheres");
+    ospSetData(occluders, "spheres",
+               ospNewData(spheres.size(), OSP_FLOAT, spheres.data()));
+    ospSet1f(occluders, "radius", 0.03f);
+    ospSet1i(occluders, "bytes_per_sphere", 3 * sizeof(float));
+    ospSetMaterial(occluders, material);
+    ospCommit(occluders);
+
+    OSPModel model = ospNewModel();
+    ospAddGeometry(model, ground);
+    ospAddGeometry(model, occluders);
+    ospCommit(model);
+
+    OSPCamera camera = ospNewCamera("perspective");
+    ospSet1f(camera, "aspect", 1.f);
+    ospSet3f(camera, "pos", 0.f, 2.f, 0.f);
+    ospSet3f(camera, "dir", 0.f, -1.f, 0.f);
+    ospSet3f(camera, "up", 0.f, 0.f, 1.f);
+    ospSet1f(camera, "fovy", 60.f);
+    ospCommit(camera);
+
+    ospSetObject(renderer, "model", model);
+    ospSetObject(renderer, "camera", camera);
+    ospSet1i(renderer, "aoSamples", 64);
+    ospSet1i(renderer, "spp", 4);
+    ospCommit(renderer);
+
+    fb = ospNewFrameBuffer(imageSize, OSP_FB_RGBA8, OSP_FB_COLOR);
+  }
+
+  //! render the next frames in red or blue
+  void setColor(bool red)
+  {
+    ospSet3f(material, "Kd", red ? 1.f : 0.f, 0.f, red ? 0.f : 1.f);
+    ospCommit(material);
+    ospCommit(renderer);
+  }
+
+  /*! number of tiles that do NOT have the given color (looking at
+      the center pixel of every tile) */
+  int countOtherTiles(bool red)
+  {
+    const unsigned char *pixels =
+      (const unsigned char *)ospMapFrameBuffer(fb, OSP_FB_COLOR);
+    int count = 0;
+    for (int ty = 0; ty < imageSize.y / tileSize; ty++)
+      for (int tx = 0; tx < imageSize.x / tileSize; tx++) {
+        const int x = tx * tileSize + tileSize / 2;
+        const int y = ty * tileSize + tileSize / 2;
+        const unsigned char *pixel = pixels + 4 * (y * imageSize.x + x);
+        if ((pixel[0] > pixel[2]) != red)
+          count++;
+      }
+    ospUnmapFrameBuffer(pixels, fb);
+    return count;
+  }
+
+  int runTest()
+  {
+    createScene();
+
+    const int numTiles = (imageSize.x / tileSize) * (imageSize.y / tileSize);
+    bool ok = true;
+    bool red = true;
+    for (int round = 0; round < numRounds; round++, red = !red) {
+      setColor(red);
+      ospRenderFrame(fb, renderer, OSP_FB_COLOR);
+      const int missed = countOtherTiles(red);
+      if (missed != 0) {
+        printf("#osp:mpi: round %i: full frame missed %i of %i tiles\n",
+               round, missed, numTiles);
+        ok = false;
+      }
+
+      setColor(!red);
+      OSPFuture future = ospRenderFrameAsync(fb, renderer, OSP_FB_COLOR);
+      ospCancel(future);
+      ospWait(future);
+      ospRelease((OSPObject)future);
+
+      const int skipped = countOtherTiles(!red);
+      printf("#osp:mpi: round %i: cancelled frame skipped %i of %i tiles\n",
+             round, skipped, numTiles);
+      if (skipped == 0)
+        ok = false;
+    }
+
+    printf("#osp:mpi: cancel test %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+  }
+
+} // ::ospray
+
+int main(int ac, const char **av)
+{
+  ospInit(&ac, av);
+  return ospray::runTest();
+}
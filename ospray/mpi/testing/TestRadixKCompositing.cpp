@@ -0,0 +1,219 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+/*! \file TestRadixKCompositing.cpp correctness and scaling test for
+  mpi::RadixKCompositor. Run with different numbers of local ranks,
+  e.g.
+
+    for n in 2 4 8 16; do mpirun -n $n ./ospray_mpi_test_compositing; done
+
+  Every rank renders a synthetic, partially transparent "slab" at a
+  rank-dependent depth into a sparse set of tiles; the composited
+  result is checked against a per-pixel reference, and the time per
+  frame and the amount of data sent are reported for different radices
+  (the largest one being plain direct-send in a single round). */
+
+#include "ospray/mpi/RadixKCompositor.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace ospray {
+
+  static const float noDepth = std::numeric_limits<float>::infinity();
+
+  //! whether 'rank' contributes to given tile at all
+  inline bool contributes(int rank, size_t tileID)
+  { return (tileID + rank) % 4 != 0; }
+
+  //! the (premultiplied) sample of 'rank' for given pixel of a tile
+  inline void sample(int rank, size_t tileID, int i,
+                     float &r, float &g, float &b, float &a, float &z)
+  {
+    if ((i + tileID + rank) % 13 == 0) {
+      r = g = b = a = 0.f;
+      z = noDepth;
+      return;
+    }
+    a = 0.1f + 0.5f*((i + 7*rank) % 16)/16.f;
+    r = a*((rank*37 + i) % 255)/255.f;
+    g = a*((rank*91 + tileID) % 255)/255.f;
+    b = a*((rank*13) % 255)/255.f;
+    z = rank + 0.5f;
+  }
+
+  void generateTiles(int rank, const vec2i &numTiles, const vec2i &fbSize,
+                     std::vector<Tile *> &tiles)
+  {
+    tiles.assign(numTiles.x*numTiles.y, nullptr);
+    for (size_t tileID = 0; tileID < tiles.size(); tileID++) {
+      if (!contributes(rank, tileID))
+        continue;
+      const vec2i tileCoords(tileID % numTiles.x, tileID / numTiles.x);
+      Tile *tile = new Tile(tileCoords, fbSize, 0);
+      for (int i = 0; i < TILE_SIZE*TILE_SIZE; i++) {
+        sample(rank, tileID, i,
+               tile->r[i], tile->g[i], tile->b[i], tile->a[i], tile->z[i]);
+      }
+      tiles[tileID] = tile;
+    }
+  }
+
+  //! returns the largest difference to the reference over all pixels
+  float checkTile(mpi::RadixKCompositor::Mode mode, int numRanks,
+                  size_t tileID, const Tile *tile)
+  {
+    float maxError = 0.f;
+    for (int i = 0; i < TILE_SIZE*TILE_SIZE; i++) {
+      float acc[4] = {0.f, 0.f, 0.f, 0.f};
+      // ranks are ordered front to back by construction
+      for (int rank = 0; rank < numRanks; rank++) {
+        if (!contributes(rank, tileID))
+          continue;
+        float s[4], z;
+        sample(rank, tileID, i, s[0], s[1], s[2], s[3], z);
+        if (z == noDepth)
+          continue;
+        if (mode == mpi::RadixKCompositor::Z_COMPOSITE) {
+          for (int c = 0; c < 4; c++) acc[c] = s[c];
+          break;
+        }
+        const float t = 1.f - acc[3];
+        for (int c = 0; c < 4; c++) acc[c] += t*s[c];
+      }
+      const float result[4] = {
+        tile ? tile->r[i] : 0.f, tile ? tile->g[i] : 0.f,
+        tile ? tile->b[i] : 0.f, tile ? tile->a[i] : 0.f
+      };
+      for (int c = 0; c < 4; c++)
+        maxError = std::max(maxError, std::fabs(result[c] - acc[c]));
+    }
+    return maxError;
+  }
+
+  int runTest(int ac, char **av)
+  {
+    vec2i fbSize(1920, 1080);
+    int numFrames = 10;
+    for (int i = 1; i < ac; i++) {
+      const std::string arg = av[i];
+      if (arg == "-w" && i+1 < ac)
+        fbSize.x = atoi(av[++i]);
+      else if (arg == "-h" && i+1 < ac)
+        fbSize.y = atoi(av[++i]);
+      else if (arg == "-frames" && i+1 < ac)
+        numFrames = atoi(av[++i]);
+    }
+
+    int rank, size;
+    MPI_CALL(Comm_rank(MPI_COMM_WORLD, &rank));
+    MPI_CALL(Comm_size(MPI_COMM_WORLD, &size));
+
+    const vec2i numTiles = divRoundUp(fbSize, vec2i(TILE_SIZE));
+    const size_t totalTiles = numTiles.x*numTiles.y;
+    if (rank == 0) {
+      printf("#osp:mpi: radix-k compositing test, %i ranks, %ix%i pixels "
+             "(%li tiles)\n", size, fbSize.x, fbSize.y, totalTiles);
+    }
+
+    int failed = 0;
+    std::vector<int> radices = {2, 4, 8, size};
+    const mpi::RadixKCompositor::Mode modes[] = {
+      mpi::RadixKCompositor::ALPHA_BLEND, mpi::RadixKCompositor::Z_COMPOSITE
+    };
+
+    for (auto mode : modes) {
+      std::vector<std::vector<int>> testedFactors;
+      for (auto radix : radices) {
+        mpi::RadixKCompositor compositor(MPI_COMM_WORLD, mode, radix);
+        if (std::find(testedFactors.begin(), testedFactors.end(),
+                      compositor.factors) != testedFactors.end())
+          continue;
+        testedFactors.push_back(compositor.factors);
+
+        double totalSeconds = 0.0;
+        size_t bytesSent = 0;
+        std::vector<Tile *> tiles;
+        for (int frame = 0; frame < numFrames; frame++) {
+          generateTiles(rank, numTiles, fbSize, tiles);
+
+          MPI_CALL(Barrier(MPI_COMM_WORLD));
+          const double t0 = getSysTime();
+          compositor.composite(tiles);
+          double seconds = getSysTime() - t0;
+          MPI_CALL(Allreduce(MPI_IN_PLACE, &seconds, 1, MPI_DOUBLE, MPI_MAX,
+                             MPI_COMM_WORLD));
+          totalSeconds += seconds;
+          bytesSent = std::max(bytesSent, compositor.bytesSent);
+
+          size_t begin, end;
+          compositor.finalTileRange(rank, totalTiles, begin, end);
+          float maxError = 0.f;
+          for (size_t i = 0; i < totalTiles; i++) {
+            if (i >= begin && i < end) {
+              if (frame == 0)
+                maxError = std::max(maxError,
+                                    checkTile(mode, size, i, tiles[i]));
+            } else if (tiles[i] != nullptr) {
+              maxError = 1.f;
+            }
+            delete tiles[i];
+          }
+          if (maxError > 1e-4f) {
+            printf("#osp:mpi: rank %i: wrong compositing result (error %f)\n",
+                   rank, maxError);
+            failed = 1;
+          }
+        }
+
+        unsigned long long maxBytes = bytesSent;
+        MPI_CALL(Allreduce(MPI_IN_PLACE, &maxBytes, 1,
+                           MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_COMM_WORLD));
+        if (rank == 0) {
+          std::string rounds;
+          for (auto k : compositor.factors)
+            rounds += (rounds.empty() ? "" : "x") + std::to_string(k);
+          printf("#osp:mpi: %s, radix %2i (rounds %s): %8.3f ms/frame, "
+                 "%8.3f MB sent per rank\n",
+                 mode == mpi::RadixKCompositor::ALPHA_BLEND ? "alpha blend"
+                                                            : "z composite",
+                 radix, rounds.empty() ? "-" : rounds.c_str(),
+                 1000.0*totalSeconds/numFrames, maxBytes/(1024.0*1024.0));
+        }
+      }
+    }
+
+    MPI_CALL(Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MAX,
+                       MPI_COMM_WORLD));
+    if (rank == 0)
+      printf("#osp:mpi: radix-k compositing test %s\n",
+             failed ? "FAILED" : "passed");
+    return failed;
+  }
+
+} // ::ospray
+
+int main(int ac, char **av)
+{
+  int provided = 0;
+  MPI_Init_thread(&ac, &av, MPI_THREAD_MULTIPLE, &provided);
+  const int result = ospray::runTest(ac, av);
+  MPI_Finalize();
+  return result;
+}
@@ -0,0 +1,138 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+/*! \file TestTileCompression.cpp round-trip test for the run-length
+  encoding the distributed frame buffer uses for tiles (see
+  TileCompression.h); does not need MPI, just run
+
+    ./ospray_mpi_test_tilecompression
+
+  Every case encodes a buffer of 32-bit words, checks that the encoder
+  gives up (rather than overflowing) when the output does not fit, and
+  that decoding reproduces the input bit for bit. */
+
+#include "ospray/mpi/TileCompression.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace ospray {
+
+  /*! encode/decode 'in' and compare; 'expectCompressed' is whether the
+      encoded data is expected to fit into the size of the raw data */
+  bool roundTrip(const char *name, const std::vector<uint32> &in,
+                 bool expectCompressed)
+  {
+    const size_t rawBytes = in.size()*sizeof(uint32);
+
+    // worst case: a single literal block plus its control word
+    std::vector<uint32> encoded(in.size()+1);
+    const size_t numBytes = mpi::compressWords(in.data(), in.size(),
+                                               encoded.data(),
+                                               encoded.size()*sizeof(uint32));
+    if (numBytes == 0 || numBytes % sizeof(uint32) != 0) {
+      printf("#osp:mpi: %s: encoding failed (%zu bytes)\n", name, numBytes);
+      return false;
+    }
+
+    // with no more room than the raw data the encoder has to bail out
+    // on incompressible input instead of writing past the buffer
+    std::vector<uint32> tight(in.size()+2, 0xdeadbeef);
+    const size_t tightBytes = mpi::compressWords(in.data(), in.size(),
+                                                 tight.data(), rawBytes);
+    if ((tightBytes != 0) != expectCompressed) {
+      printf("#osp:mpi: %s: expected data to %s (got %zu of %zu bytes)\n",
+             name, expectCompressed ? "compress" : "not compress",
+             tightBytes, rawBytes);
+      return false;
+    }
+    if (tight[in.size()] != 0xdeadbeef || tight[in.size()+1] != 0xdeadbeef) {
+      printf("#osp:mpi: %s: encoder wrote past the output buffer\n", name);
+      return false;
+    }
+
+    std::vector<uint32> decoded(in.size(), 0);
+    try {
+      mpi::decompressWords(encoded.data(), numBytes,
+                           decoded.data(), decoded.size());
+    } catch (const std::runtime_error &e) {
+      printf("#osp:mpi: %s: decoding failed (%s)\n", name, e.what());
+      return false;
+    }
+    if (memcmp(decoded.data(), in.data(), rawBytes) != 0) {
+      printf("#osp:mpi: %s: decoded data differs from input\n", name);
+      return false;
+    }
+
+    // decoding into a buffer of the wrong size has to be detected
+    try {
+      std::vector<uint32> shorter(in.size()-1);
+      mpi::decompressWords(encoded.data(), numBytes,
+                           shorter.data(), shorter.size());
+      printf("#osp:mpi: %s: size mismatch not detected\n", name);
+      return false;
+    } catch (const std::runtime_error &) {
+    }
+
+    printf("#osp:mpi: %s: %zu -> %zu bytes, ok\n", name, rawBytes, numBytes);
+    return true;
+  }
+
+  int runTest()
+  {
+    const size_t numPixels = TILE_SIZE*TILE_SIZE;
+    bool ok = true;
+
+    // constant background, the common case: collapses to a single run
+    std::vector<uint32> constant(numPixels, 0x3f000000);
+    ok &= roundTrip("constant tile", constant, true);
+
+    // no two neighboring words are equal: stays a single literal block
+    std::vector<uint32> noise(numPixels);
+    uint32 state = 0x12345678;
+    for (size_t i = 0; i < noise.size(); i++) {
+      state = state*1664525u + 1013904223u;
+      noise[i] = state;
+      if (i > 0 && noise[i] == noise[i-1])
+        noise[i]++;
+    }
+    ok &= roundTrip("incompressible tile", noise, false);
+
+    // odd number of words, mixing runs of different lengths (including
+    // runs of two, which the encoder keeps as literals) and literals,
+    // ending in a run
+    std::vector<uint32> mixed;
+    for (uint32 block = 0; mixed.size() < 2*numPixels+1; block++) {
+      const size_t len = 1 + (block*7) % 5;
+      for (size_t j = 0; j < len; j++)
+        mixed.push_back(block % 3 ? block : block*1000+j);
+    }
+    mixed.resize(2*numPixels+1);
+    mixed[mixed.size()-2] = mixed[mixed.size()-1] = 42;
+    ok &= roundTrip("odd pixel count", mixed, true);
+
+    printf("#osp:mpi: tile compression test %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+  }
+
+} // ::ospray
+
+int main()
+{
+  return ospray::runTest();
+}
@@ -30,6 +30,111 @@ namespace ospray {
 
   TiledLoadBalancer *TiledLoadBalancer::instance = NULL;
 
+  // NOTE: caps how much of the budget a single (very noisy) tile can
+  // take in one frame, so the rest of the image keeps refining, too
+  static const int maxTilePassesPerFrame = 16;
+
+  void TiledLoadBalancer::computeTilePasses(const Renderer *renderer,
+                                            FrameBuffer *fb,
+                                            const std::vector<int> &tileIndices,
+                                            int64 sampleBudget,
+                                            std::vector<int> &passes)
+  {
+    const size_t numTiles = tileIndices.size();
+    const vec2i numTiles_xy = fb->getNumTiles();
+    passes.assign(numTiles, 0);
+
+    std::vector<float> error(numTiles);
+    std::vector<int> active;
+    for (size_t i = 0; i < numTiles; i++) {
+      const vec2i tileID(tileIndices[i] % numTiles_xy.x,
+                         tileIndices[i] / numTiles_xy.x);
+      error[i] = fb->tileError(tileID);
+      if (error[i] > renderer->errorThreshold)
+        active.push_back(i);
+    }
+
+    // multiple passes only make sense if they get accumulated, and
+    // subsampling (spp < 1) has its own progression
+    if (sampleBudget <= 0 || renderer->spp < 1 || !fb->hasAccumBuffer) {
+      for (size_t i = 0; i < active.size(); i++)
+        passes[active[i]] = 1;
+      return;
+    }
+
+    auto passCost = [&](int i) -> int64 {
+      const vec2i lower(tileIndices[i] % numTiles_xy.x * TILE_SIZE,
+                        tileIndices[i] / numTiles_xy.x * TILE_SIZE);
+      const vec2i upper = min(lower + TILE_SIZE, fb->size);
+      return int64(upper.x - lower.x) * (upper.y - lower.y) * renderer->spp;
+    };
+
+    // tiles without an error estimate yet count as the noisiest ones
+    float maxFiniteError = 0.f;
+    for (size_t i = 0; i < active.size(); i++)
+      if (std::isfinite(error[active[i]]))
+        maxFiniteError = std::max(maxFiniteError, error[active[i]]);
+    const float unknownError = maxFiniteError > 0.f ? maxFiniteError : 1.f;
+    for (size_t i = 0; i < active.size(); i++)
+      if (!std::isfinite(error[active[i]]))
+        error[active[i]] = unknownError;
+
+    std::sort(active.begin(), active.end(),
+              [&](int a, int b) { return error[a] > error[b]; });
+
+    // first, one pass for as many tiles as the budget allows, noisiest
+    // first (but always at least one, so the frame makes progress) ...
+    int64 remaining = sampleBudget;
+    double weightedCost = 0.;
+    size_t numScheduled = 0;
+    for (; numScheduled < active.size(); numScheduled++) {
+      const int i = active[numScheduled];
+      const int64 cost = passCost(i);
+      if (cost > remaining && numScheduled > 0)
+        break;
+      passes[i] = 1;
+      remaining -= cost;
+      weightedCost += double(error[i]) * cost;
+    }
+
+    // ... then distribute what is left proportionally to the error
+    if (remaining <= 0 || weightedCost <= 0.)
+      return;
+    for (size_t n = 0; n < numScheduled; n++) {
+      const int i = active[n];
+      const int extra = int(remaining * double(error[i]) / weightedCost);
+      passes[i] = std::min(1 + extra, maxTilePassesPerFrame);
+    }
+  }
+
+  void TiledLoadBalancer::scheduleTilesByCost(const FrameBuffer *fb,
+                                              std::vector<int> &tiles,
+                                              std::vector<char> &splitJobs)
+  {
+    const std::vector<float> &cost = fb->tileRenderTime;
+
+    double totalCost = 0.;
+    for (size_t i = 0; i < tiles.size(); i++)
+      totalCost += cost[tiles[i]];
+
+    const size_t threads = numThreads > 0 ? numThreads
+                                          : getNumberOfLogicalThreads();
+    // NOTE: without timings (first frame) or with too few tiles to keep
+    // all threads busy, every tile has to be split into jobs
+    if (totalCost <= 0. || tiles.size() < 4*threads) {
+      splitJobs.assign(tiles.size(), true);
+      return;
+    }
+
+    std::stable_sort(tiles.begin(), tiles.end(),
+                     [&](int a, int b) { return cost[a] > cost[b]; });
+
+    const float meanCost = totalCost / tiles.size();
+    splitJobs.resize(tiles.size());
+    for (size_t i = 0; i < tiles.size(); i++)
+      splitJobs[i] = cost[tiles[i]] > 2.f*meanCost;
+  }
+
   LocalTiledLoadBalancer::LocalTiledLoadBalancer()
 #ifdef OSPRAY_TASKING_TBB
     : tbb_init(numThreads)
@@ -47,23 +152,52 @@ namespace ospray {
 
     void *perFrameData = renderer->beginFrame(fb);
 
+    std::vector<int> tiles(fb->getTotalTiles());
+    for (size_t i = 0; i < tiles.size(); i++)
+      tiles[i] = i;
+    std::vector<int> tilePasses;
+    computeTilePasses(renderer, fb, tiles, renderer->sampleBudget, tilePasses);
+
+    std::vector<char> splitJobs;
+    scheduleTilesByCost(fb, tiles, splitJobs);
+
     parallel_for(fb->getTotalTiles(), [&](int taskIndex) {
+      if (fb->isFrameCancelled())
+        return;
+
+      const int tileIndex = tiles[taskIndex];
       const size_t numTiles_x = fb->getNumTiles().x;
-      const size_t tile_y = taskIndex / numTiles_x;
-      const size_t tile_x = taskIndex - tile_y*numTiles_x;
+      const size_t tile_y = tileIndex / numTiles_x;
+      const size_t tile_x = tileIndex - tile_y*numTiles_x;
       const vec2i tileID(tile_x, tile_y);
-      const int32 accumID = fb->accumID(tileID);
 
-      if (fb->tileError(tileID) <= renderer->errorThreshold)
+      if (tilePasses[tileIndex] == 0) {
+        fb->setTileRenderTime(tileIndex, 0.f);
+        fb->reportTileDone();
         return;
+      }
 
-      Tile __aligned(64) tile(tileID, fb->size, accumID);
+      const double t0 = getSysTime();
+      Tile __aligned(64) tile(tileID, fb->size, fb->accumID(tileID));
+
+      for (int pass = 0; pass < tilePasses[tileIndex]; pass++) {
+        const int32 accumID = fb->accumID(tileID);
+        tile.accumID = accumID;
 
-      parallel_for(numJobs(renderer->spp, accumID), [&](int tIdx) {
-        renderer->renderTile(perFrameData, tile, tIdx);
-      });
+        const int jobs = numJobs(renderer->spp, accumID);
+        if (splitJobs[taskIndex]) {
+          parallel_for(jobs, [&](int tIdx) {
+            renderer->renderTile(perFrameData, tile, tIdx);
+          });
+        } else {
+          for (int tIdx = 0; tIdx < jobs; tIdx++)
+            renderer->renderTile(perFrameData, tile, tIdx);
+        }
 
-      fb->setTile(tile);
+        fb->setTile(tile);
+      }
+      fb->setTileRenderTime(tileIndex, getSysTime() - t0);
+      fb->reportTileDone();
     });
 
     renderer->endFrame(perFrameData,channelFlags);
@@ -96,7 +230,30 @@ namespace ospray {
     const int NTASKS = (numTiles_total / numDevices)
                        + (numTiles_total % numDevices > deviceID);
 
-    parallel_for(NTASKS, [&](int taskIndex) {
+    // every device gets its share of the sample budget
+    std::vector<int> tiles(NTASKS);
+    for (int i = 0; i < NTASKS; i++)
+      tiles[i] = deviceID + numDevices * i;
+    std::vector<int> tilePasses;
+    computeTilePasses(renderer, fb, tiles,
+                      renderer->sampleBudget / numDevices, tilePasses);
+
+    // tilePasses is indexed by the original position of the tile
+    std::vector<int> order(NTASKS);
+    std::vector<char> splitJobs;
+    {
+      // NOTE: sort the positions by the cost of the tiles they refer to
+      std::vector<int> sortedTiles = tiles;
+      scheduleTilesByCost(fb, sortedTiles, splitJobs);
+      for (int i = 0; i < NTASKS; i++)
+        order[i] = (sortedTiles[i] - deviceID) / numDevices;
+    }
+
+    parallel_for(NTASKS, [&](int orderIndex) {
+      if (fb->isFrameCancelled())
+        return;
+
+      const int taskIndex = order[orderIndex];
       int tileIndex = deviceID + numDevices * taskIndex;
       const size_t numTiles_x = fb->getNumTiles().x;
       const size_t tile_y = tileIndex / numTiles_x;
@@ -104,8 +261,13 @@ namespace ospray {
       const vec2i tileID(tile_x, tile_y);
       const int32 accumID = fb->accumID(tileID);
 
-      if (fb->tileError(tileID) <= renderer->errorThreshold)
+      if (tilePasses[taskIndex] == 0) {
+        fb->setTileRenderTime(tileIndex, 0.f);
+        fb->reportTileDone();
         return;
+      }
+
+      const double t0 = getSysTime();
 
 #ifdef __MIC__
 #  define MAX_TILE_SIZE 32
@@ -120,11 +282,23 @@ namespace ospray {
       Tile __aligned(64) tile(tileID, fb->size, accumID);
 #endif
 
-      parallel_for(numJobs(renderer->spp, accumID), [&](int tIdx) {
-        renderer->renderTile(perFrameData, tile, tIdx);
-      });
+      for (int pass = 0; pass < tilePasses[taskIndex]; pass++) {
+        tile.accumID = pass == 0 ? accumID : fb->accumID(tileID);
+
+        const int jobs = numJobs(renderer->spp, tile.accumID);
+        if (splitJobs[orderIndex]) {
+          parallel_for(jobs, [&](int tIdx) {
+            renderer->renderTile(perFrameData, tile, tIdx);
+          });
+        } else {
+          for (int tIdx = 0; tIdx < jobs; tIdx++)
+            renderer->renderTile(perFrameData, tile, tIdx);
+        }
 
-      fb->setTile(tile);
+        fb->setTile(tile);
+      }
+      fb->setTileRenderTime(tileIndex, getSysTime() - t0);
+      fb->reportTileDone();
 #if TILE_SIZE>MAX_TILE_SIZE
       delete tilePtr;
 #endif
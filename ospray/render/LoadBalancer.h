@@ -46,6 +46,33 @@ namespace ospray {
         std::min(1 << -2 * spp, TILE_SIZE*TILE_SIZE);
       return divRoundUp((TILE_SIZE*TILE_SIZE)/RENDERTILE_PIXELS_PER_JOB, blocks);
     }
+
+    /*! \brief how often each of the given tiles gets rendered (and
+        accumulated) in this frame
+
+        Tiles whose error estimate is below the renderer's
+        errorThreshold get no pass at all. If a sampleBudget (total
+        number of pixel samples for this frame) is given, that budget
+        is distributed over the remaining tiles proportionally to
+        their error, so noisy tiles get several passes within one
+        frame; otherwise every remaining tile gets exactly one pass. */
+    static void computeTilePasses(const Renderer *renderer,
+                                  FrameBuffer *fb,
+                                  const std::vector<int> &tileIndices,
+                                  int64 sampleBudget,
+                                  std::vector<int> &passes);
+
+    /*! \brief reorders 'tiles' by decreasing render time in the
+        previous frame, so the most expensive tiles get started first
+
+        'splitJobs[i]' tells whether the jobs of the i'th (reordered)
+        tile should be spread over all threads: true for expensive
+        tiles (and for all tiles if there are not that many); the jobs
+        of the cheap tiles run in a single task, which saves
+        scheduling overhead. */
+    static void scheduleTilesByCost(const FrameBuffer *fb,
+                                    std::vector<int> &tiles,
+                                    std::vector<char> &splitJobs);
   };
 
   //! tiled load balancer for local rendering on the given machine
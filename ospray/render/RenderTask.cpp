@@ -0,0 +1,69 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#include "RenderTask.h"
+
+namespace ospray {
+
+  RenderTask::RenderTask(FrameBuffer *fb, Renderer *renderer)
+    : fb(fb),
+      renderer(renderer),
+      frameID(0),
+      finished(false),
+      result(inf)
+  {
+    // NOTE: renderer may be null on the master of a distributed device
+    Assert(fb);
+    fb->beginFrameProgress();
+  }
+
+  bool RenderTask::isFinished()
+  {
+    SCOPED_LOCK(mutex);
+    return finished;
+  }
+
+  float RenderTask::wait()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    finishedCond.wait(lock, [&](){ return finished; });
+
+    if (!error.empty())
+      throw std::runtime_error(error);
+
+    return result;
+  }
+
+  void RenderTask::cancel()
+  {
+    fb->cancelFrame();
+  }
+
+  float RenderTask::getProgress() const
+  {
+    return fb->getFrameProgress();
+  }
+
+  void RenderTask::finish(float result, const std::string &error)
+  {
+    SCOPED_LOCK(mutex);
+    this->result = result;
+    this->error  = error;
+    finished     = true;
+    finishedCond.notify_all();
+  }
+
+} // ::ospray
@@ -0,0 +1,98 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+#pragma once
+
+/*! \file RenderTask.h Defines a frame that is rendered asynchronously */
+
+#include "render/Renderer.h"
+#include "common/tasking/async.h"
+
+namespace ospray {
+
+  /*! \brief a frame that is being rendered asynchronously (this is
+      what the application gets as an OSPFuture)
+
+    \detailed The device creates the task (on the application thread)
+    and hands the function that actually renders the frame to
+    start(), which runs it on the tasking system. Canceling only
+    prevents the load balancer from scheduling any more tiles of this
+    frame, it does not interrupt tiles that are being rendered.
+   */
+  struct RenderTask : public ManagedObject
+  {
+    RenderTask(FrameBuffer *fb, Renderer *renderer);
+
+    /*! \brief run 'renderFrame' (which returns what ospRenderFrame()
+        would return) asynchronously */
+    template <typename RENDER_FCN>
+    void start(const RENDER_FCN &renderFrame);
+
+    //! returns whether the frame is finished (or cancelled and finished)
+    bool isFinished();
+
+    //! wait for the frame to finish, and return renderFrame's result
+    float wait();
+
+    //! stop scheduling tiles of this frame
+    void cancel();
+
+    //! fraction [0..1] of tiles done
+    float getProgress() const;
+
+    std::string toString() const override { return "ospray::RenderTask"; }
+
+    Ref<FrameBuffer> fb;
+    Ref<Renderer>    renderer;
+
+    /*! ID of the frame on a distributed frame buffer (see
+        DistributedFrameBuffer::issueFrame()), unused otherwise */
+    int32 frameID;
+
+  private:
+
+    //! called (from the tasking system) once the frame is done
+    void finish(float result, const std::string &error);
+
+    Mutex     mutex;
+    Condition finishedCond;
+    bool      finished;
+    float     result;
+    //! error message if rendering threw an exception, empty otherwise
+    std::string error;
+  };
+
+  // Inlined function definitions /////////////////////////////////////////////
+
+  template <typename RENDER_FCN>
+  inline void RenderTask::start(const RENDER_FCN &renderFrame)
+  {
+    // NOTE: keep ourselves (and thus fb and renderer) alive until the
+    //       frame is done, even if the app releases the future
+    refInc();
+    RenderTask *self = this;
+
+    async([=]() {
+      try {
+        self->finish(renderFrame(), "");
+      } catch (const std::runtime_error &e) {
+        self->finish(inf, e.what());
+      }
+      self->refDec();
+    });
+  }
+
+} // ::ospray
@@ -37,6 +37,7 @@ namespace ospray {
     epsilon = getParam1f("epsilon", 1e-6f);
     spp = getParam1i("spp", 1);
     errorThreshold = getParam1f("varianceThreshold", 0.f);
+    sampleBudget = getParam1i("sampleBudget", 0);
     backgroundEnabled = getParam1i("backgroundEnabled", 1);
     maxDepthTexture = (Texture2D*)getParamObject("maxDepthTexture", NULL);
     model = (Model*)getParamObject("model", getParamObject("world"));
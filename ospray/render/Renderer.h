@@ -35,7 +35,7 @@ namespace ospray {
     compositing or even projection/splatting based approaches
    */
   struct Renderer : public ManagedObject {
-    Renderer() : spp(1), errorThreshold(0.0f) {}
+    Renderer() : spp(1), errorThreshold(0.0f), sampleBudget(0) {}
 
     /*! \brief creates an abstract renderer class of given type
 
@@ -92,6 +92,11 @@ namespace ospray {
     /*! adaptive accumulation: variance-based error to reach */
     float errorThreshold;
 
+    /*! adaptive sampling: total number of pixel samples per frame,
+        distributed over the tiles according to their error estimate
+        (0 = every unconverged tile gets 'spp' samples per pixel) */
+    int32 sampleBudget;
+
     /*! \brief whether the background should be rendered (e.g. for compositing the background may be disabled) */
     bool backgroundEnabled;
 
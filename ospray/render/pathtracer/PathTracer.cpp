@@ -23,10 +23,12 @@
 // ispc exports
 #include "PathTracer_ispc.h"
 // std
+#include <algorithm>
+#include <cmath>
 #include <map>
 
 namespace ospray {
-  PathTracer::PathTracer() : Renderer()
+  PathTracer::PathTracer() : Renderer(), collectStats(false)
   {
     ispcEquivalent = ispc::PathTracer_create(this);
   }
@@ -57,21 +59,79 @@ namespace ospray {
     lightData = (Data*)getParamData("lights");
 
     lightArray.clear();
+    lightCDF.clear();
 
+    // lights at infinity get sampled at every vertex, the others are
+    // selected by their power
+    std::vector<Light*> localLights;
     if (lightData)
-      for (int i = 0; i < lightData->size(); i++)
-        lightArray.push_back(((Light**)lightData->data)[i]->getIE());
+      for (int i = 0; i < lightData->size(); i++) {
+        Light *light = ((Light**)lightData->data)[i];
+        if (std::isinf(light->getPower()))
+          lightArray.push_back(light->getIE());
+        else
+          localLights.push_back(light);
+      }
+    const size_t numInfiniteLights = lightArray.size();
+
+    float sum = 0.f;
+    for (size_t i = 0; i < localLights.size(); i++) {
+      lightArray.push_back(localLights[i]->getIE());
+      sum += std::max(localLights[i]->getPower(), 0.f);
+      lightCDF.push_back(sum);
+    }
+    for (size_t i = 0; i < lightCDF.size(); i++)
+      lightCDF[i] = sum > 0.f ? lightCDF[i]/sum : (i+1)/float(lightCDF.size());
 
     void **lightPtr = lightArray.empty() ? NULL : &lightArray[0];
+    float *cdfPtr = lightCDF.empty() ? NULL : &lightCDF[0];
+    // number of lights selected by power at each vertex
+    const int32 lightSamples = std::max(getParam1i("lightSamples", 1), 1);
 
     const int32 maxDepth = getParam1i("maxDepth", 20);
     const float minContribution = getParam1f("minContribution", 0.01f);
     const float maxRadiance = getParam1f("maxContribution", getParam1f("maxRadiance", inf));
     Texture2D *backplate = (Texture2D*)getParamObject("backplate", NULL);
+    // trace all paths of a tile bounce by bounce, sorted by material
+    const bool wavefront = getParam1i("wavefront", 0);
+    collectStats = getParam1i("stats", 0);
 
     ispc::PathTracer_set(getIE(), maxDepth, minContribution, maxRadiance,
                          backplate ? backplate->getIE() : NULL,
-                         lightPtr, lightArray.size());
+                         lightPtr, lightArray.size(),
+                         numInfiniteLights, cdfPtr, lightSamples,
+                         wavefront, collectStats);
+  }
+
+  PathTracer::Stats PathTracer::getStats() const
+  {
+    int64 values[3];
+    ispc::PathTracer_getStats(getIE(), values);
+    Stats stats;
+    stats.rays = values[0];
+    stats.shadingLanes = values[1];
+    stats.shadingSlots = values[2];
+    return stats;
+  }
+
+  void PathTracer::resetStats()
+  {
+    ispc::PathTracer_resetStats(getIE());
+  }
+
+  void PathTracer::endFrame(void *perFrameData, const int32 fbChannelFlags)
+  {
+    Renderer::endFrame(perFrameData, fbChannelFlags);
+
+    // the counters are kept per frame, only print them when verbose
+    if (collectStats) {
+      const Stats stats = getStats();
+      if (logLevel >= 1) {
+        std::cout << "#osp:PT: " << stats.rays << " rays traced, shading simd "
+                  << "efficiency " << stats.simdEfficiency() << std::endl;
+      }
+      resetStats();
+    }
   }
 
   OSP_REGISTER_RENDERER(PathTracer,pathtracer);
@@ -25,9 +25,28 @@ namespace ospray {
     virtual std::string toString() const { return "ospray::PathTracer"; }
     virtual void commit();
     virtual Material *createMaterial(const char *type);
+    /*! prints (when verbose) and resets the statistics if they are collected */
+    virtual void endFrame(void *perFrameData, const int32 fbChannelFlags);
 
-    std::vector<void*> lightArray; // the 'IE's of the XXXLights
+    /*! counters collected while rendering in wavefront mode with the
+        "stats" parameter set */
+    struct Stats {
+      int64 rays;         //!< rays traced, including shadow rays
+      int64 shadingLanes; //!< active lanes during material shading
+      int64 shadingSlots; //!< available lanes during material shading
+
+      //! fraction of the SIMD lanes doing useful work when shading
+      float simdEfficiency() const
+      { return shadingSlots ? shadingLanes/float(shadingSlots) : 0.f; }
+    };
+
+    Stats getStats() const;
+    void resetStats();
+
+    std::vector<void*> lightArray; // the 'IE's of the XXXLights, lights at infinity first
+    std::vector<float> lightCDF; // of the power of the other lights
     Data *lightData;
+    bool collectStats;
   };
 }
 
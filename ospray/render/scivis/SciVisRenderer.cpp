@@ -50,6 +50,8 @@ namespace ospray {
       int   numAOSamples = getParam1i("aoSamples", 0);
       float rayLength    = getParam1f("aoOcclusionDistance", 1e20f);
       float aoWeight     = getParam1f("aoWeight", 0.25f);
+      // trace the AO rays of a pixel block in sorted, coherent packets
+      bool  aoBatching   = getParam1i("aoBatching", 1);
 
       ispc::SciVisRenderer_set(getIE(),
                                shadowsEnabled,
@@ -58,7 +60,8 @@ namespace ospray {
                                rayLength,
                                aoWeight,
                                lightPtr,
-                               lightArray.size());
+                               lightArray.size(),
+                               aoBatching);
     }
 
     SciVisRenderer::SciVisRenderer()
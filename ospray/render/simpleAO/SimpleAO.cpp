@@ -51,7 +51,9 @@ namespace ospray {
 
     int   numSamples = getParam1i("aoSamples", defaultNumSamples);
     float rayLength  = getParam1f("aoOcclusionDistance", 1e20f);
-    ispc::SimpleAO_set(getIE(), numSamples, rayLength);
+    // trace the AO rays of a pixel block in sorted, coherent packets
+    bool  aoBatching = getParam1i("aoBatching", 1);
+    ispc::SimpleAO_set(getIE(), numSamples, rayLength, aoBatching);
   }
 
   // OSP_REGISTER_RENDERER(SimpleAO, ao);
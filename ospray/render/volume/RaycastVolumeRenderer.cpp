@@ -26,6 +26,8 @@
 #include "RaycastVolumeRenderer_ispc.h"
 #if EXP_DATA_PARALLEL
 # include "mpi/DistributedFrameBuffer.h"
+# include "DistributedFrameBuffer_ispc.h"
+# include "mpi/RadixKCompositor.h"
 # include "volume/DataDistributedBlockedVolume.h"
 # include "render/LoadBalancer.h"
 #endif
@@ -114,6 +116,14 @@ namespace ospray {
     uint32                    channelFlags;
     const DataDistributedBlockedVolume *dpv;
 
+    /*! if set, compositing is done by a RadixKCompositor: the partial
+        tile of this rank goes to 'partialTile', the background tile to
+        'backgroundTile', and the rank in 'finalOwner' renders
+        the background of that tile */
+    std::vector<Tile *> *partialTile;
+    std::vector<Tile *> *backgroundTile;
+    const std::vector<int> *finalOwner;
+
     void operator()(int taskIndex) const;
   };
 
@@ -134,8 +144,9 @@ namespace ospray {
     for (int i = 0; i < numBlocks; i++)
       blockWasVisible[i] = false;
 
-    bool renderForeAndBackground =
-        (taskIndex % core::getWorkerCount()) == core::getWorkerRank();
+    bool renderForeAndBackground = finalOwner
+        ? (*finalOwner)[taskIndex] == core::getWorkerRank()
+        : (taskIndex % core::getWorkerCount()) == core::getWorkerRank();
 
     const int numJobs = (TILE_SIZE*TILE_SIZE)/RENDERTILE_PIXELS_PER_JOB;
 
@@ -153,6 +164,41 @@ namespace ospray {
                                      tid);
     });
 
+    if (partialTile) {
+      // blend all fragments of this rank into one partial tile; the
+      // background has to stay separate, it goes behind the fragments
+      // of *all* ranks
+      std::vector<Tile *> fragments;
+      if (renderForeAndBackground) {
+        fragments.push_back(&fgTile);
+        (*backgroundTile)[taskIndex] = new Tile(bgTile);
+      }
+      for (int blockID = 0; blockID < numBlocks; blockID++) {
+        Tile *tile = blockTileCache.blockTile[blockID];
+        if (tile)
+          fragments.push_back(tile);
+      }
+      if (fragments.empty())
+        return;
+
+      Tile *partial = new Tile(bgTile);
+      for (int i = 0; i < TILE_SIZE*TILE_SIZE; i++) {
+        partial->z[i] = inf;
+        for (auto *fragment : fragments)
+          partial->z[i] = std::min(partial->z[i], fragment->z[i]);
+      }
+      if (fragments.size() > 1) {
+        ispc::DFB_sortAndBlendFragments((ispc::VaryingTile **)&fragments[0],
+                                        fragments.size());
+      }
+      // NOTE: the compositor orders partial tiles by their closest depth
+      memcpy(partial->r, fragments[0]->r, sizeof(partial->r));
+      memcpy(partial->g, fragments[0]->g, sizeof(partial->g));
+      memcpy(partial->b, fragments[0]->b, sizeof(partial->b));
+      memcpy(partial->a, fragments[0]->a, sizeof(partial->a));
+      (*partialTile)[taskIndex] = partial;
+      return;
+    }
 
     if (renderForeAndBackground) {
       // this is a tile owned by me - i'm responsible for writing
@@ -262,7 +308,8 @@ namespace ospray {
                                "not using the distributed frame buffer!?");
     }
 
-    dfb->setFrameMode(DistributedFrameBuffer::ALPHA_BLEND);
+    dfb->setFrameMode(radixK >= 2 ? DistributedFrameBuffer::WRITE_ONCE
+                                  : DistributedFrameBuffer::ALPHA_BLEND);
 
     // note: we can NEVER be the master, since the master doesn't even
     // have an instance of this renderer class -
@@ -291,9 +338,61 @@ namespace ospray {
     renderTask.numTiles_y = divRoundUp(dfb->size.y, TILE_SIZE);
     renderTask.channelFlags = channelFlags;
     renderTask.dpv = ddVolumeVec[0];
+    renderTask.partialTile = nullptr;
+    renderTask.backgroundTile = nullptr;
+    renderTask.finalOwner = nullptr;
 
     size_t NTASKS = renderTask.numTiles_x * renderTask.numTiles_y;
-    parallel_for(NTASKS, renderTask);
+
+    if (radixK >= 2) {
+      // NOTE: all workers render the frame, so they all get here together
+      //       (creating the compositor is a collective operation)
+      if (!compositor || compositor->radix != radixK) {
+        compositor.reset();
+        compositor = std::make_shared<mpi::RadixKCompositor>
+          (mpi::worker.comm, mpi::RadixKCompositor::ALPHA_BLEND, radixK);
+      }
+
+      std::vector<int> finalOwner(NTASKS);
+      for (int rank = 0; rank < compositor->size; rank++) {
+        size_t begin, end;
+        compositor->finalTileRange(rank, NTASKS, begin, end);
+        for (size_t i = begin; i < end; i++)
+          finalOwner[i] = rank;
+      }
+
+      std::vector<Tile *> partialTile(NTASKS, nullptr);
+      std::vector<Tile *> backgroundTile(NTASKS, nullptr);
+      renderTask.partialTile = &partialTile;
+      renderTask.backgroundTile = &backgroundTile;
+      renderTask.finalOwner = &finalOwner;
+      parallel_for(NTASKS, renderTask);
+
+      compositor->composite(partialTile);
+
+      // put the background behind the composited tiles we ended up with,
+      // and hand them to the frame buffer
+      size_t begin, end;
+      compositor->finalTileRange(compositor->rank, NTASKS, begin, end);
+      parallel_for(end - begin, [&](int i) {
+        Tile *bg = backgroundTile[begin + i];
+        Tile *fg = partialTile[begin + i];
+        if (fg) {
+          for (int j = 0; j < TILE_SIZE*TILE_SIZE; j++) {
+            const float t = 1.f - fg->a[j];
+            bg->r[j] = fg->r[j] + t * bg->r[j];
+            bg->g[j] = fg->g[j] + t * bg->g[j];
+            bg->b[j] = fg->b[j] + t * bg->b[j];
+            bg->a[j] = fg->a[j] + t * bg->a[j];
+          }
+          delete fg;
+        }
+        fb->setTile(*bg);
+        delete bg;
+      });
+    } else {
+      parallel_for(NTASKS, renderTask);
+    }
 
     dfb->waitUntilFinished();
     Renderer::endFrame(nullptr, channelFlags);
@@ -323,6 +422,14 @@ namespace ospray {
                                           lights.empty() ? nullptr : &lights[0],
                                           lights.size());
 
+    // Use pre-integrated transfer function tables where available.
+    ispc::RaycastVolumeRenderer_setPreIntegration(ispcEquivalent,
+                                                  getParam1i("preIntegration", 0));
+
+#if EXP_DATA_PARALLEL
+    radixK = getParam1i("radixK", 0);
+#endif
+
     // Initialize state in the parent class, must be called after the ISPC
     // object is created.
     Renderer::commit();
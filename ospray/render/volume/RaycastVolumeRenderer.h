@@ -18,8 +18,18 @@
 
 #include "render/Renderer.h"
 
+#if EXP_DATA_PARALLEL
+# include <memory>
+#endif
+
 namespace ospray {
 
+#if EXP_DATA_PARALLEL
+  namespace mpi {
+    struct RadixKCompositor;
+  }
+#endif
+
   //! \brief A concrete implemetation of the Renderer class for rendering
   //!  volumes optionally containing embedded surfaces.
   //!
@@ -59,11 +69,25 @@ namespace ospray {
     //! ISPC equivalents for lights.
     std::vector<void *> lights;
 
+#if EXP_DATA_PARALLEL
+    /*! radix of the compositing rounds for data-parallel rendering
+        (2 = binary swap); 0 sends all partial tiles to the tile owner
+        in the distributed frame buffer instead */
+    int radixK;
+
+    /*! compositor used if 'radixK' is set, (re-)created on the first
+        frame rendered with a given 'radixK' */
+    std::shared_ptr<mpi::RadixKCompositor> compositor;
+#endif
+
   };
 
   // Inlined function definitions /////////////////////////////////////////////
 
   inline RaycastVolumeRenderer::RaycastVolumeRenderer()
+#if EXP_DATA_PARALLEL
+    : radixK(0)
+#endif
   {
   }
 
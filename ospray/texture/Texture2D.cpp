@@ -16,15 +16,158 @@
 
 #include "Texture2D.h"
 #include "Texture2D_ispc.h"
+#include "common/tasking/parallel_for.h"
 
 namespace ospray {
 
+  static int numChannels(const OSPTextureFormat type)
+  {
+    switch (type) {
+    case OSP_TEXTURE_RGBA8:
+    case OSP_TEXTURE_SRGBA:
+    case OSP_TEXTURE_RGBA32F: return 4;
+    case OSP_TEXTURE_RGB8:
+    case OSP_TEXTURE_SRGB:
+    case OSP_TEXTURE_RGB32F:  return 3;
+    default:                  return 1;
+    }
+  }
+
+  static bool isFloat(const OSPTextureFormat type)
+  {
+    return type == OSP_TEXTURE_RGBA32F || type == OSP_TEXTURE_RGB32F
+      || type == OSP_TEXTURE_R32F;
+  }
+
+  static bool isSRGB(const OSPTextureFormat type)
+  {
+    return type == OSP_TEXTURE_SRGBA || type == OSP_TEXTURE_SRGB;
+  }
+
+  static float srgbToLinear(const float c)
+  {
+    return c <= 0.04045f ? c * (1.f/12.92f)
+                         : powf((c + 0.055f) * (1.f/1.055f), 2.4f);
+  }
+
+  static float linearToSrgb(const float c)
+  {
+    return c <= 0.0031308f ? c * 12.92f
+                           : 1.055f * powf(c, 1.f/2.4f) - 0.055f;
+  }
+
+  /*! index of texel (x,y); must match texelIndex() in Texture2D.ispc */
+  static size_t texelIndex(const vec2i &size, const bool tiled,
+                           const int x, const int y)
+  {
+    if (!tiled)
+      return size_t(y) * size.x + x;
+
+    const size_t tileCols = (size.x + 3) / 4;
+    return (((y >> 2) * tileCols + (x >> 2)) << 4) + ((y & 3) << 2) + (x & 3);
+  }
+
+  /*! number of texels allocated for a texture, tiled textures are padded
+      to whole 4x4 tiles */
+  static size_t numTexels(const vec2i &size, const bool tiled)
+  {
+    if (!tiled)
+      return size_t(size.x) * size.y;
+
+    return size_t((size.x + 3) & ~3) * ((size.y + 3) & ~3);
+  }
+
+  /*! read one texel as (linear) floats; sRGB is decoded such that mip
+      levels are averaged in linear space */
+  static void readTexel(const OSPTextureFormat type, const void *data,
+                        const size_t index, float *c)
+  {
+    const int n = numChannels(type);
+    if (isFloat(type)) {
+      for (int i = 0; i < n; i++)
+        c[i] = ((const float *)data)[index * n + i];
+    } else {
+      for (int i = 0; i < n; i++)
+        c[i] = ((const unsigned char *)data)[index * n + i] * (1.f/255.f);
+      if (isSRGB(type))
+        for (int i = 0; i < 3; i++)
+          c[i] = srgbToLinear(c[i]);
+    }
+  }
+
+  static void writeTexel(const OSPTextureFormat type, void *data,
+                         const size_t index, const float *c)
+  {
+    const int n = numChannels(type);
+    if (isFloat(type)) {
+      for (int i = 0; i < n; i++)
+        ((float *)data)[index * n + i] = c[i];
+    } else {
+      for (int i = 0; i < n; i++) {
+        const float v = (isSRGB(type) && i < 3) ? linearToSrgb(c[i]) : c[i];
+        ((unsigned char *)data)[index * n + i] =
+          (unsigned char)(clamp(v, 0.f, 1.f) * 255.f + 0.5f);
+      }
+    }
+  }
+
   Texture2D::~Texture2D()
   {
+    if (ispcEquivalent)
+      ispc::Texture2D_destroyLevels(ispcEquivalent);
+    for (size_t i = 0; i < mipData.size(); i++)
+      delete[] mipData[i];
     if (!(flags & OSP_TEXTURE_SHARED_BUFFER))
       delete[] (unsigned char *)data;
   }
 
+  /*! build the mip-map chain down to 1x1 by 2x2 box filtering; each level
+      is computed from the previous one, rows in parallel */
+  void Texture2D::generateMipLevels()
+  {
+    const size_t texelBytes = sizeOf(type);
+    const int n = numChannels(type);
+
+    std::vector<vec2i> levelSize(1, size);
+    std::vector<void *> levelData(1, data);
+    bool srcTiled = tiled;
+
+    while (levelSize.back().x > 1 || levelSize.back().y > 1) {
+      const vec2i src = levelSize.back();
+      const void *srcData = levelData.back();
+      const vec2i dst(std::max(src.x / 2, 1), std::max(src.y / 2, 1));
+      unsigned char *dstData = new unsigned char[numTexels(dst, true) * texelBytes];
+
+      parallel_for(dst.y, [&](int y) {
+        const int y0 = std::min(2 * y, src.y - 1);
+        const int y1 = std::min(2 * y + 1, src.y - 1);
+        for (int x = 0; x < dst.x; x++) {
+          const int x0 = std::min(2 * x, src.x - 1);
+          const int x1 = std::min(2 * x + 1, src.x - 1);
+          float c[4][4];
+          readTexel(type, srcData, texelIndex(src, srcTiled, x0, y0), c[0]);
+          readTexel(type, srcData, texelIndex(src, srcTiled, x1, y0), c[1]);
+          readTexel(type, srcData, texelIndex(src, srcTiled, x0, y1), c[2]);
+          readTexel(type, srcData, texelIndex(src, srcTiled, x1, y1), c[3]);
+          float avg[4];
+          for (int i = 0; i < n; i++)
+            avg[i] = 0.25f * (c[0][i] + c[1][i] + c[2][i] + c[3][i]);
+          writeTexel(type, dstData, texelIndex(dst, true, x, y), avg);
+        }
+      });
+
+      levelSize.push_back(dst);
+      levelData.push_back(dstData);
+      mipData.push_back(dstData);
+      srcTiled = true;
+    }
+
+    if (levelSize.size() > 1)
+      ispc::Texture2D_setLevels(ispcEquivalent, levelSize.size(),
+                                (ispc::vec2i *)&levelSize[0], &levelData[0],
+                                type, flags);
+  }
+
   Texture2D *Texture2D::createTexture(const vec2i &size,
       const OSPTextureFormat type, void *data, const int flags) 
   {
@@ -35,18 +178,38 @@ namespace ospray {
     tx->flags = flags;
     tx->managedObjectType = OSP_TEXTURE;
 
-    const size_t bytes = sizeOf(type) * size.x * size.y;
-
     assert(data);
 
-    if (flags & OSP_TEXTURE_SHARED_BUFFER) {
+    // a shared buffer has to be used as is, our own copy is re-ordered
+    // into tiles
+    tx->tiled = !(flags & OSP_TEXTURE_SHARED_BUFFER);
+
+    if (!tx->tiled) {
       tx->data = data;
     } else {
+      const size_t texelBytes = sizeOf(type);
+      const size_t bytes = texelBytes * numTexels(size, true);
       tx->data = bytes ? new unsigned char[bytes] : NULL;
-      memcpy(tx->data, data, bytes);
+      if (bytes)
+        memset(tx->data, 0, bytes);
+
+      parallel_for(size.y, [&](int y) {
+        const unsigned char *row = (const unsigned char *)data
+          + texelBytes * size_t(y) * size.x;
+        for (int x = 0; x < size.x; x++)
+          memcpy((unsigned char *)tx->data
+                 + texelBytes * texelIndex(size, true, x, y),
+                 row + texelBytes * x, texelBytes);
+      });
     }
 
-    tx->ispcEquivalent = ispc::Texture2D_create((ispc::vec2i&)size, tx->data, type, flags);
+    tx->ispcEquivalent = ispc::Texture2D_create((ispc::vec2i&)size, tx->data,
+                                                type, flags, tx->tiled);
+
+    // nearest-neighbor textures are used as lookup tables (e.g. depth
+    // buffers) and are never minified
+    if ((flags & OSP_TEXTURE_MIPMAP) && !(flags & OSP_TEXTURE_FILTER_NEAREST))
+      tx->generateMipLevels();
 
     return tx;
   }
@@ -18,6 +18,8 @@
 
 #include "common/Managed.h"
 #include "ospray/OSPTexture.h"
+// stl
+#include <vector>
 
 namespace ospray {
 
@@ -34,10 +36,20 @@ namespace ospray {
     static Texture2D *createTexture(const vec2i &size, const OSPTextureFormat, 
                                     void *data, const int flags);
 
+    /*! build the mip-map chain and pass it to the ispc side */
+    void generateMipLevels();
+
     vec2i size;
     OSPTextureFormat type;
     void *data;
     int flags;
+
+    /*! true if 'data' is stored in 4x4 texel tiles rather than in
+        scanline order; only textures that own their buffer are tiled */
+    bool tiled;
+    /*! texels of the (always tiled) mip-map levels 1..n, generated at
+        creation if requested with OSP_TEXTURE_MIPMAP */
+    std::vector<unsigned char *> mipData;
   };
 
 } // ::ospray
@@ -55,10 +55,88 @@ namespace ospray {
     vec2f valueRange = getParam2f("valueRange", vec2f(0.0f, 1.0f));  
     ispc::TransferFunction_setValueRange(ispcEquivalent, (const ispc::vec2f &) valueRange);
 
+    // Build the pre-integrated color/opacity table if requested.
+    if (getParam1i("preIntegration", 0))
+      computePreIntegrationTable();
+    else
+      preIntegrationTable.clear();
+
+    ispc::LinearTransferFunction_setPreIntegrationTable(ispcEquivalent,
+      preIntegrationTable.empty() ? NULL : (ispc::vec4f *) &preIntegrationTable[0],
+      preIntegrationTable.empty() ? 0 : PREINTEGRATION_TABLE_SIZE);
+
     // Notify listeners that the transfer function has changed.
     notifyListenersThatObjectGotChanged();
   }
 
+  /*! \detailed For a ray segment with front sample value sf and back
+      sample value sb we assume the value varies linearly along the
+      segment. With extinction tau(s) = -log(1 - opacity(s)) per
+      sampling step (so a single step reproduces the plain transfer
+      function opacity) and the running integrals T(s) = int tau and
+      C(s) = int tau*color, the segment's mean extinction is
+      (T(sb)-T(sf))/(sb-sf) and its mean color (C(sb)-C(sf))/(T(sb)-T(sf)).
+      The segment opacity 1-exp(-tau*length) is computed at lookup time,
+      so the table does not depend on the sampling rate. */
+  void LinearTransferFunction::computePreIntegrationTable()
+  {
+    const int N = PREINTEGRATION_TABLE_SIZE;
+
+    const vec3f *colors  = colorValues ? (const vec3f *)colorValues->data : NULL;
+    const size_t numColors  = colorValues ? colorValues->numItems : 0;
+    const float *opacities = opacityValues ? (const float *)opacityValues->data : NULL;
+    const size_t numOpacities = opacityValues ? opacityValues->numItems : 0;
+
+    // Classify N equally spaced values across the value range, with the
+    // same piecewise linear interpolation as the ISPC lookups.
+    std::vector<vec3f> color(N);
+    std::vector<float> tau(N);
+    for (int i = 0; i < N; i++) {
+      const float t = i / float(N - 1);
+
+      color[i] = vec3f(1.f);
+      if (numColors > 0) {
+        const float x = t * (numColors - 1);
+        const size_t i0 = std::min(size_t(x), numColors - 1);
+        const size_t i1 = std::min(i0 + 1, numColors - 1);
+        color[i] = colors[i0] + (x - i0) * (colors[i1] - colors[i0]);
+      }
+
+      float opacity = 1.f;
+      if (numOpacities > 0) {
+        const float x = t * (numOpacities - 1);
+        const size_t i0 = std::min(size_t(x), numOpacities - 1);
+        const size_t i1 = std::min(i0 + 1, numOpacities - 1);
+        opacity = opacities[i0] + (x - i0) * (opacities[i1] - opacities[i0]);
+      }
+      tau[i] = -logf(std::max(1.f - opacity, 1e-6f));
+    }
+
+    // Running integrals of extinction and extinction-weighted color
+    // (trapezoidal rule, in units of one table entry).
+    std::vector<float> T(N, 0.f);
+    std::vector<vec3f> C(N, vec3f(0.f));
+    for (int i = 1; i < N; i++) {
+      T[i] = T[i-1] + 0.5f * (tau[i-1] + tau[i]);
+      C[i] = C[i-1] + 0.5f * (tau[i-1] * color[i-1] + tau[i] * color[i]);
+    }
+
+    preIntegrationTable.resize(N * N);
+    for (int b = 0; b < N; b++)
+      for (int f = 0; f < N; f++) {
+        vec4f &entry = preIntegrationTable[b * N + f];
+        if (f == b) {
+          entry = vec4f(color[f].x, color[f].y, color[f].z, tau[f]);
+          continue;
+        }
+        const float dT = fabsf(T[b] - T[f]);
+        const vec3f meanColor = dT > 1e-6f
+          ? (C[b] - C[f]) * (1.f / (T[b] - T[f]))
+          : 0.5f * (color[f] + color[b]);
+        entry = vec4f(meanColor.x, meanColor.y, meanColor.z, dT / abs(b - f));
+      }
+  }
+
   void LinearTransferFunction::createEquivalentISPC()
   {
     // The equivalent ISPC transfer function must not exist yet.
@@ -23,6 +23,9 @@
 // std
 #include <vector>
 
+//! resolution of the pre-integrated transfer function table per dimension
+#define PREINTEGRATION_TABLE_SIZE 256
+
 namespace ospray {
 
   /*! \brief A concrete implementation of the TransferFunction class for
@@ -55,6 +58,16 @@ namespace ospray {
     //! Create the equivalent ISPC transfer function.
     virtual void createEquivalentISPC();
 
+    /*! build the pre-integrated color/opacity table for the current
+        color and opacity maps (see preIntegrationTable) */
+    void computePreIntegrationTable();
+
+    /*! pre-integrated table, indexed by the front and back sample
+        values of a ray segment; rgb is the extinction-weighted mean
+        color along the segment and w the mean extinction per
+        sampling step. only built if 'preIntegration' is set. */
+    std::vector<vec4f> preIntegrationTable;
+
   };
 
 } // ::ospray
@@ -0,0 +1,144 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+// ospcommon
+#include "ospcommon/vec.h"
+// ospray
+#include "ospray/OSPDataType.h"
+// std
+#include <algorithm>
+#include <cstring>
+#include <stdint.h>
+
+namespace ospray {
+
+  using ospcommon::vec2f;
+  using ospcommon::vec3i;
+
+  //! Magic bytes at the start of every bricked volume file.
+#define BRICKED_VOLUME_FILE_MAGIC "OSPBRICK"
+
+  //! Version of the bricked volume file layout described below.
+#define BRICKED_VOLUME_FILE_VERSION (1)
+
+  //! Default brick width in voxels (including the ghost layer).
+#define BRICKED_VOLUME_FILE_BRICK_WIDTH (64)
+
+  //! Width of a value range cell in voxels, must match CELL_WIDTH in
+  //! GridAccelerator.ispc.
+#define BRICKED_VOLUME_FILE_CELL_WIDTH (16)
+
+  //! Alignment of the brick data in the file.
+#define BRICKED_VOLUME_FILE_PAGE_SIZE (4096)
+
+  //! \brief Header of the on-disk format read by the out_of_core_bricked_volume.
+  /*! \detailed The header is followed by the value range of every
+    GridAccelerator cell (cellCount vec2f, x fastest) at cellRangeOffset
+    and by the bricks at brickDataOffset.
+
+    A brick holds brickWidth^3 voxels in x-fastest order. Neighboring
+    bricks overlap by one voxel, brick i starting at voxel i *
+    (brickWidth - 1), so the 2x2x2 neighborhood of every voxel lies in
+    a single brick. Voxels past the volume boundary repeat the last
+    voxel. Every brick is padded to a multiple of the page size so that
+    it can be paged in and out on its own.
+
+    The cell ranges allow building the space skipping structure without
+    touching the voxel data. */
+  struct BrickedVolumeFileHeader {
+
+    char magic[8];
+    uint32_t version;
+
+    //! OSPDataType of the voxels.
+    int32_t voxelType;
+
+    //! Voxel size in bytes.
+    uint32_t voxelSize;
+
+    //! Brick width in voxels, including the ghost layer.
+    int32_t brickWidth;
+
+    int32_t dimensions[3];
+    int32_t brickCount[3];
+    int32_t cellCount[3];
+
+    //! Range of all voxel values in the volume.
+    float voxelRange[2];
+
+    //! Size of a brick in the file, including padding.
+    uint64_t brickBytes;
+
+    uint64_t cellRangeOffset;
+    uint64_t brickDataOffset;
+
+    //! Lay out a file for a volume of the given type and dimensions.
+    void init(OSPDataType type, size_t size, const vec3i &dims, int width)
+    {
+      memset(this, 0, sizeof(*this));
+      memcpy(magic, BRICKED_VOLUME_FILE_MAGIC, sizeof(magic));
+      version = BRICKED_VOLUME_FILE_VERSION;
+      voxelType = type;
+      voxelSize = size;
+      brickWidth = width;
+      for (int i = 0; i < 3; i++) {
+        dimensions[i] = dims[i];
+        brickCount[i] = std::max(dims[i] - 2, 0) / (width - 1) + 1;
+        cellCount[i] = (dims[i] + BRICKED_VOLUME_FILE_CELL_WIDTH - 1)
+          / BRICKED_VOLUME_FILE_CELL_WIDTH;
+      }
+      voxelRange[0] = voxelRange[1] = 0.f;
+      brickBytes = pageAlign((uint64_t)width * width * width * size);
+      cellRangeOffset = sizeof(BrickedVolumeFileHeader);
+      brickDataOffset = pageAlign(cellRangeOffset
+                                  + numCells() * sizeof(vec2f));
+    }
+
+    //! Check the magic bytes and the version.
+    bool valid() const
+    {
+      return memcmp(magic, BRICKED_VOLUME_FILE_MAGIC, sizeof(magic)) == 0
+        && version == BRICKED_VOLUME_FILE_VERSION;
+    }
+
+    uint64_t numBricks() const
+    { return (uint64_t)brickCount[0] * brickCount[1] * brickCount[2]; }
+
+    uint64_t numCells() const
+    { return (uint64_t)cellCount[0] * cellCount[1] * cellCount[2]; }
+
+    //! Size of the whole file in bytes.
+    uint64_t fileSize() const
+    { return brickDataOffset + numBricks() * brickBytes; }
+
+    //! File offset of the brick with the given 3D index.
+    uint64_t brickOffset(const vec3i &brick) const
+    {
+      return brickDataOffset + brickBytes *
+        (brick.x + brickCount[0] * (brick.y + (uint64_t)brickCount[1] * brick.z));
+    }
+
+    static uint64_t pageAlign(uint64_t bytes)
+    {
+      return (bytes + BRICKED_VOLUME_FILE_PAGE_SIZE - 1)
+        / BRICKED_VOLUME_FILE_PAGE_SIZE * BRICKED_VOLUME_FILE_PAGE_SIZE;
+    }
+  };
+
+} // ::ospray
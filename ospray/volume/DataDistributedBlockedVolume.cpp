@@ -78,6 +78,14 @@ namespace ospray {
                                                              1.f));
       cppVolume->findParam("gradientShadingEnabled",
                            1)->set(getParam1i("gradientShadingEnabled", 0));
+      cppVolume->findParam("adaptiveSampling",
+                           1)->set(getParam1i("adaptiveSampling", 0));
+      cppVolume->findParam("adaptiveScalar",
+                           1)->set(getParam1f("adaptiveScalar", 15.f));
+      cppVolume->findParam("adaptiveMinSamplingRate",
+                           1)->set(getParam1f("adaptiveMinSamplingRate", 0.25f));
+      cppVolume->findParam("adaptiveMaxSamplingRate",
+                           1)->set(getParam1f("adaptiveMaxSamplingRate", 2.f));
 
       cppVolume.ptr->updateEditableParameters();
     }
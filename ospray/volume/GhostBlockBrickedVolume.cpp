@@ -64,54 +64,20 @@ namespace ospray {
     if (ispcEquivalent == nullptr)
       createEquivalentISPC();
 
-    /*! \todo check if we still need this 'computevoxelrange' - in
-        theory we need this only if the app is allowed to query these
-        values, and they're not being set in sharedstructuredvolume,
-        either, so should we actually set them at all!? */
-    // Compute the voxel value range for unsigned byte voxels if none was
-    // previously specified.
     Assert2(source,"nullptr source in GhostBlockBrickedVolume::setRegion()");
 
-#ifndef OSPRAY_VOLUME_VOXELRANGE_IN_APP
-    if (findParam("voxelRange") == NULL) {
-      // Compute the voxel value range for float voxels if none was
-      // previously specified.
-      const size_t numVoxelsInRegion
-        = (size_t)regionSize.x *
-        + (size_t)regionSize.y *
-        + (size_t)regionSize.z;
-      if (voxelType == "uchar")
-        computeVoxelRange((unsigned char *)source, numVoxelsInRegion);
-      else if (voxelType == "ushort")
-        computeVoxelRange((unsigned short *)source, numVoxelsInRegion);
-      else if (voxelType == "float")
-        computeVoxelRange((float *)source, numVoxelsInRegion);
-      else if (voxelType == "double")
-        computeVoxelRange((double *) source, numVoxelsInRegion);
-      else {
-        throw std::runtime_error("invalid voxelType in "
-                                 "GhostBlockBrickedVolume::setRegion()");
-      }
-    }
-#endif
-
-    vec3i finalRegionSize = regionSize;
-    vec3i finalRegionCoords = regionCoords;
-    void *finalSource = const_cast<void*>(source);
-    const bool upsampling = scaleRegion(source, finalSource, finalRegionSize, finalRegionCoords);
-    // Copy voxel data into the volume.
-    const int NTASKS = finalRegionSize.y * finalRegionSize.z;
-    parallel_for(NTASKS, [&](int taskIndex){
+    // Copy voxel data into the volume, a row per task. The voxel value range
+    // and the accelerator cell ranges are accumulated on the way.
+    streamRegion(source, regionCoords, regionSize,
+                 [&](const void *finalSource, const vec3i &finalRegionCoords,
+                     const vec3i &finalRegionSize){
+      copyRegionRows(finalSource, finalRegionCoords, finalRegionSize,
+                     [&](int taskIndex){
         ispc::GBBV_setRegion(ispcEquivalent, finalSource, (const ispc::vec3i&)finalRegionCoords,
             (const ispc::vec3i&)finalRegionSize, taskIndex);
+      });
     });
 
-    // If we're upsampling finalSource points at the chunk of data allocated by scaleRegion
-    // to hold the upsampled volume data and we must free it.
-    if (upsampling) {
-      free(finalSource);
-    }
-
     return true;
   }
 
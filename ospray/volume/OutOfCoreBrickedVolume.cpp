@@ -0,0 +1,395 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+//ospray
+#include "volume/OutOfCoreBrickedVolume.h"
+#include "common/tasking/parallel_for.h"
+#include "OutOfCoreBrickedVolume_ispc.h"
+#include "StructuredVolume_ispc.h"
+// std
+#include <climits>
+#include <set>
+#include <thread>
+// stdlib, for mmap
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#  include <windows.h>
+#else
+#  include <sys/mman.h>
+#  include <unistd.h>
+#endif
+#include <fcntl.h>
+
+// O_LARGEFILE is a GNU extension.
+#ifdef __APPLE__
+#define  O_LARGEFILE  0
+#endif
+
+namespace ospray {
+
+  //! IDs of the volumes alive, a thread releases its pinned brick only if
+  //! the volume still exists.
+  static std::mutex liveVolumesMutex;
+  static std::set<uint64> liveVolumes;
+  static uint64 nextVolumeID = 1;
+
+  //! The brick a thread keeps pinned between voxel fetches, see getBrick().
+  struct PinnedBrick {
+    OutOfCoreBrickedVolume *volume {nullptr};
+    uint64 volumeID {0};
+    uint32 brickID {0};
+    const void *data {nullptr};
+
+    //! Release the brick, unless its volume is gone.
+    void release()
+    {
+      if (volume == nullptr)
+        return;
+      std::lock_guard<std::mutex> lock(liveVolumesMutex);
+      if (liveVolumes.count(volumeID))
+        volume->unpinBrick(brickID);
+      volume = nullptr;
+      volumeID = 0;
+    }
+
+    //! Threads exiting must not keep a cache slot pinned.
+    ~PinnedBrick() { release(); }
+  };
+
+  static thread_local PinnedBrick pinnedBrick;
+
+  OutOfCoreBrickedVolume::OutOfCoreBrickedVolume() :
+    mappedFile(nullptr),
+    slotOfBrick(nullptr),
+    brickLoads(0)
+  {
+    std::lock_guard<std::mutex> lock(liveVolumesMutex);
+    volumeID = nextVolumeID++;
+    liveVolumes.insert(volumeID);
+  }
+
+  OutOfCoreBrickedVolume::~OutOfCoreBrickedVolume()
+  {
+    {
+      std::lock_guard<std::mutex> lock(liveVolumesMutex);
+      liveVolumes.erase(volumeID);
+    }
+    closeFile();
+  }
+
+  std::string OutOfCoreBrickedVolume::toString() const
+  {
+    return("ospray::OutOfCoreBrickedVolume<" + voxelType + ">");
+  }
+
+  void OutOfCoreBrickedVolume::commit()
+  {
+    // The file is opened on the first commit, later commits may only change
+    // the editable parameters.
+    if (ispcEquivalent == nullptr) {
+      const std::string fileName = getParamString("filename", "");
+      exitOnCondition(fileName.empty(),
+                      "no 'filename' given for the out_of_core_bricked_volume");
+      openFile(fileName);
+      createEquivalentISPC();
+    }
+
+    // StructuredVolume commit actions.
+    StructuredVolume::commit();
+  }
+
+  int OutOfCoreBrickedVolume::setRegion(const void *, const vec3i &,
+                                        const vec3i &)
+  {
+    std::cerr << "#osp:out_of_core_bricked_volume: ospSetRegion() is not "
+              << "supported, convert the volume with ospRaw2Bricks" << std::endl;
+    return 0;
+  }
+
+  const void *OutOfCoreBrickedVolume::pinBrick(uint32 brickID)
+  {
+    for (;;) {
+      const int slotID = slotOfBrick[brickID].load();
+
+      if (slotID < 0) {
+        // Not cached, the loading thread gets the brick pinned.
+        const int loadedSlotID = loadBrick(brickID);
+        if (loadedSlotID >= 0)
+          return slots[loadedSlotID]->data;
+        continue;
+      }
+
+      BrickSlot &slot = *slots[slotID];
+      if (slot.pins.fetch_add(1) >= 0) {
+        // The slot may have been given to another brick meanwhile.
+        if (slot.brickID.load() == brickID) {
+          const int64 now = brickLoads.load(std::memory_order_relaxed);
+          if (slot.lastUse.load(std::memory_order_relaxed) != now)
+            slot.lastUse.store(now, std::memory_order_relaxed);
+          return slot.data;
+        }
+        slot.pins.fetch_sub(1);
+      } else {
+        // The slot is being loaded.
+        slot.pins.fetch_sub(1);
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void OutOfCoreBrickedVolume::unpinBrick(uint32 brickID)
+  {
+    BrickSlot &slot = *slots[slotOfBrick[brickID].load()];
+
+    // The brick may have been pinned for a long time, count it as used now.
+    slot.lastUse.store(brickLoads.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    slot.pins.fetch_sub(1);
+  }
+
+  const void *OutOfCoreBrickedVolume::getBrick(uint32 brickID)
+  {
+    PinnedBrick &pinned = pinnedBrick;
+    if (pinned.volumeID == volumeID && pinned.brickID == brickID)
+      return pinned.data;
+
+    // Release the previous brick before pinning the next one, loadBrick()
+    // relies on each thread pinning at most one brick at a time.
+    if (pinned.volumeID == volumeID)
+      unpinBrick(pinned.brickID);
+    else
+      pinned.release();
+
+    pinned.volume = this;
+    pinned.volumeID = volumeID;
+    pinned.brickID = brickID;
+    pinned.data = pinBrick(brickID);
+    return pinned.data;
+  }
+
+  int OutOfCoreBrickedVolume::loadBrick(uint32 brickID)
+  {
+    int slotID = -1;
+
+    {
+      std::lock_guard<std::mutex> lock(cacheMutex);
+
+      // Another thread may have loaded the brick meanwhile.
+      if (slotOfBrick[brickID].load() >= 0)
+        return -1;
+
+      // Take the least recently used slot that nobody reads from. Each
+      // thread pins at most one brick at a time, so one is free eventually.
+      for (;;) {
+        int64 oldest = LLONG_MAX;
+        for (size_t i = 0; i < slots.size(); i++) {
+          if (slots[i]->pins.load() == 0 && slots[i]->lastUse.load() < oldest) {
+            slotID = i;
+            oldest = slots[i]->lastUse.load();
+          }
+        }
+
+        int unpinned = 0;
+        if (slotID >= 0 &&
+            slots[slotID]->pins.compare_exchange_strong(unpinned, SLOT_LOADING))
+          break;
+
+        slotID = -1;
+        std::this_thread::yield();
+      }
+
+      BrickSlot &slot = *slots[slotID];
+      const int64 evictedBrickID = slot.brickID.load();
+      if (evictedBrickID >= 0)
+        slotOfBrick[evictedBrickID].store(-1);
+
+      slot.brickID.store(brickID);
+      slot.lastUse.store(++brickLoads);
+      slotOfBrick[brickID].store(slotID);
+    }
+
+    // Copy the brick from the file without holding the lock, other threads
+    // wait for it in pinBrick().
+    const vec3i brickCount(header.brickCount[0], header.brickCount[1],
+                           header.brickCount[2]);
+    const vec3i brickIndex(brickID % brickCount.x,
+                           (brickID / brickCount.x) % brickCount.y,
+                           brickID / ((uint64)brickCount.x * brickCount.y));
+    const char *source = mappedFile + header.brickOffset(brickIndex);
+    const size_t width = header.brickWidth;
+    memcpy(slots[slotID]->data, source, width * width * width * header.voxelSize);
+
+#ifndef _WIN32
+    // The cache holds the brick now, the page cache does not need to.
+    madvise((void *)source, header.brickBytes, MADV_DONTNEED);
+#endif
+
+    // Publish the brick, pinned for the calling thread.
+    slots[slotID]->pins.fetch_add(1 - SLOT_LOADING);
+    return slotID;
+  }
+
+  void OutOfCoreBrickedVolume::openFile(const std::string &fileName)
+  {
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFile(fileName.c_str(), GENERIC_READ,
+                                   FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL, nullptr);
+    exitOnCondition(fileHandle == INVALID_HANDLE_VALUE,
+                    "could not open volume file '" + fileName + "'");
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(fileHandle, &fileSize);
+    HANDLE fileMappingHandle = CreateFileMapping(fileHandle, nullptr,
+                                                 PAGE_READONLY, 0, 0, nullptr);
+    exitOnCondition(fileMappingHandle == nullptr,
+                    "could not map volume file '" + fileName + "'");
+    mappedFile = (const char *)MapViewOfFile(fileMappingHandle, FILE_MAP_READ,
+                                             0, 0, 0);
+    const uint64 mappedSize = fileSize.QuadPart;
+#else
+    int fd = ::open(fileName.c_str(), O_LARGEFILE | O_RDONLY);
+    exitOnCondition(fd == -1, "could not open volume file '" + fileName + "'");
+    struct stat fileStat;
+    fstat(fd, &fileStat);
+    const uint64 mappedSize = fileStat.st_size;
+    void *mapping = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    mappedFile = (mapping == MAP_FAILED) ? nullptr : (const char *)mapping;
+#endif
+    exitOnCondition(mappedFile == nullptr,
+                    "could not map volume file '" + fileName + "'");
+
+    // Validate the header.
+    exitOnCondition(mappedSize < sizeof(header),
+                    "'" + fileName + "' is not a bricked volume file");
+    memcpy(&header, mappedFile, sizeof(header));
+    exitOnCondition(!header.valid(),
+                    "'" + fileName + "' is not a bricked volume file");
+    exitOnCondition(mappedSize < header.fileSize(),
+                    "bricked volume file '" + fileName + "' is truncated");
+
+    const OSPDataType type = (OSPDataType)header.voxelType;
+    exitOnCondition(type != OSP_UCHAR && type != OSP_USHORT &&
+                    type != OSP_FLOAT && type != OSP_DOUBLE,
+                    "unsupported voxel type in '" + fileName + "'");
+    exitOnCondition(header.voxelSize != sizeOf(type) || header.brickWidth < 2,
+                    "corrupt header in '" + fileName + "'");
+
+    // Make the volume layout visible to the application.
+    voxelType = type == OSP_UCHAR  ? "uchar"  :
+                type == OSP_USHORT ? "ushort" :
+                type == OSP_FLOAT  ? "float"  : "double";
+    set("voxelType", voxelType.c_str());
+    set("dimensions", vec3i(header.dimensions[0], header.dimensions[1],
+                            header.dimensions[2]));
+    voxelRange = vec2f(header.voxelRange[0], header.voxelRange[1]);
+
+    // Size the cache to the memory budget, but keep enough slots for every
+    // thread to pin a brick while others are being loaded.
+    const size_t budget = size_t(getParam1i("memoryBudget", 1024)) << 20;
+    const size_t numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const size_t numSlots = std::min<size_t>(
+        std::max<size_t>(budget / header.brickBytes, 2 * numThreads),
+        header.numBricks());
+
+    slotOfBrick = new std::atomic<int>[header.numBricks()];
+    for (size_t i = 0; i < header.numBricks(); i++)
+      slotOfBrick[i].store(-1);
+
+    slots.resize(numSlots);
+    for (size_t i = 0; i < numSlots; i++) {
+      slots[i] = new BrickSlot;
+      slots[i]->pins.store(0);
+      slots[i]->brickID.store(-1);
+      slots[i]->lastUse.store(-1);
+      slots[i]->data = alignedMalloc(header.brickBytes);
+    }
+
+    if (logLevel >= 1) {
+      std::cout << "#osp:out_of_core_bricked_volume: " << header.numBricks()
+                << " bricks, caching " << numSlots << " ("
+                << ((numSlots * header.brickBytes) >> 20) << " MB)"
+                << std::endl;
+    }
+  }
+
+  void OutOfCoreBrickedVolume::closeFile()
+  {
+    if (mappedFile == nullptr)
+      return;
+
+    if (logLevel >= 2) {
+      std::cout << "#osp:out_of_core_bricked_volume: " << brickLoads.load()
+                << " brick loads" << std::endl;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(mappedFile);
+#else
+    munmap((void *)mappedFile, header.fileSize());
+#endif
+    mappedFile = nullptr;
+
+    for (size_t i = 0; i < slots.size(); i++) {
+      alignedFree(slots[i]->data);
+      delete slots[i];
+    }
+    slots.clear();
+
+    delete[] slotOfBrick;
+    slotOfBrick = nullptr;
+  }
+
+  void OutOfCoreBrickedVolume::createEquivalentISPC()
+  {
+    this->dimensions = vec3i(header.dimensions[0], header.dimensions[1],
+                             header.dimensions[2]);
+    const vec3i brickCount(header.brickCount[0], header.brickCount[1],
+                           header.brickCount[2]);
+
+    ispcEquivalent = ispc::OutOfCoreBrickedVolume_createInstance(this,
+                                         header.voxelType,
+                                         (const ispc::vec3i &)this->dimensions,
+                                         header.brickWidth,
+                                         (const ispc::vec3i &)brickCount);
+  }
+
+  void OutOfCoreBrickedVolume::buildAccelerator()
+  {
+    // Create instance of volume accelerator.
+    void *accel = ispc::StructuredVolume_createAccelerator(ispcEquivalent);
+
+    // The cell value ranges were computed when the file was written, so no
+    // brick needs to be loaded here.
+    setAcceleratorCellRanges(accel,
+                             (const vec2f *)(mappedFile + header.cellRangeOffset));
+
+    buildMacrocellLevels(accel);
+  }
+
+  // Bricks are paged in from ISPC while sampling.
+  extern "C" const void *OutOfCoreBrickedVolume_getBrick(void *cppVolume,
+                                                         uint32 brickID)
+  {
+    return ((OutOfCoreBrickedVolume *)cppVolume)->getBrick(brickID);
+  }
+
+  // A volume type paging bricks from a file into a bounded cache.
+  OSP_REGISTER_VOLUME(OutOfCoreBrickedVolume, out_of_core_bricked_volume);
+
+} // ::ospray
@@ -0,0 +1,124 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+#include "volume/StructuredVolume.h"
+#include "volume/BrickedVolumeFile.h"
+// std
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace ospray {
+
+  //! \brief A concrete implementation of the StructuredVolume class
+  //!  which pages bricks of voxels on demand from a bricked volume file.
+  //!
+  //!  The file (see BrickedVolumeFile.h, written by ospRaw2Bricks) is
+  //!  memory mapped, and bricks touched by the renderer are copied into a
+  //!  cache bounded by the 'memoryBudget' parameter (in MB), evicting the
+  //!  least recently loaded brick that is not in use. Space skipping uses
+  //!  the cell value ranges stored in the file, so committing the volume
+  //!  does not read any voxels.
+  //!
+  class OutOfCoreBrickedVolume : public StructuredVolume {
+  public:
+
+    OutOfCoreBrickedVolume();
+    ~OutOfCoreBrickedVolume();
+
+    //! A string description of this class.
+    std::string toString() const override;
+
+    //! Open the volume file, called through the OSPRay API.
+    void commit() override;
+
+    //! The voxels of this volume type come from its file only.
+    int setRegion(const void *source,
+                  const vec3i &index,
+                  const vec3i &count) override;
+
+    //! Return the voxels of the given brick, loading it if needed. The brick
+    //! stays in the cache until released with unpinBrick().
+    const void *pinBrick(uint32 brickID);
+
+    //! Release a brick returned by pinBrick().
+    void unpinBrick(uint32 brickID);
+
+    //! Return the voxels of the given brick for the calling thread. The
+    //! thread keeps the brick pinned until it asks for another one, so
+    //! repeated reads of the same brick skip the pin counting.
+    const void *getBrick(uint32 brickID);
+
+  private:
+
+    //! Create the equivalent ISPC volume container.
+    void createEquivalentISPC() override;
+
+    //! Fill the accelerator from the cell value ranges stored in the file.
+    void buildAccelerator() override;
+
+    //! Map the volume file and set up the brick cache.
+    void openFile(const std::string &fileName);
+
+    //! Unmap the volume file and release the brick cache.
+    void closeFile();
+
+    //! Load a brick that is not in the cache, evicting another one.
+    int loadBrick(uint32 brickID);
+
+    //! Pin count of a slot that is being (re)loaded.
+    static const int SLOT_LOADING = -(1 << 30);
+
+    //! A cache entry holding one brick.
+    struct BrickSlot {
+      //! Number of readers of the slot, SLOT_LOADING while loading.
+      std::atomic<int> pins;
+      //! The brick held by the slot, or -1.
+      std::atomic<int64> brickID;
+      //! Value of brickLoads when the brick was last read, used to find
+      //! eviction candidates.
+      std::atomic<int64> lastUse;
+      //! The voxels of the brick.
+      void *data;
+    };
+
+    //! Header of the mapped file.
+    BrickedVolumeFileHeader header;
+
+    //! The mapped file.
+    const char *mappedFile;
+
+    //! Cache slot holding each brick, or -1.
+    std::atomic<int> *slotOfBrick;
+
+    //! The brick cache.
+    std::vector<BrickSlot *> slots;
+
+    //! Protects the assignment of bricks to slots.
+    std::mutex cacheMutex;
+
+    //! Number of brick loads, also the clock for the eviction order.
+    std::atomic<int64> brickLoads;
+
+    //! Unique ID of this volume, tells the bricks a thread keeps pinned
+    //! (see getBrick()) apart from those of destroyed volumes.
+    uint64 volumeID;
+  };
+
+} // ::ospray
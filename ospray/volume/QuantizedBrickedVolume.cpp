@@ -0,0 +1,328 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+//ospray
+#include "volume/QuantizedBrickedVolume.h"
+#include "common/tasking/parallel_for.h"
+#include "QuantizedBrickedVolume_ispc.h"
+// std
+#include <cmath>
+
+namespace ospray {
+
+  //! The code of voxel 'i' in a brick of 'bits' bit codes, 12 bit codes
+  //! are packed as in QuantizedBrickedVolume_getCode_uint12().
+  static uint32 getCode(const uint8 *brick, int bits, int i)
+  {
+    if (bits == 8)
+      return brick[i];
+    if (bits == 16)
+      return ((const uint16 *)brick)[i];
+
+    const size_t ofs = (i * 3) >> 1;
+    const uint32 word = brick[ofs] | (brick[ofs + 1] << 8);
+    return (i & 1) ? word >> 4 : word & 0xfff;
+  }
+
+  //! Store the code of voxel 'i' in a brick of 'bits' bit codes.
+  static void setCode(uint8 *brick, int bits, int i, uint32 code)
+  {
+    if (bits == 8) {
+      brick[i] = code;
+    } else if (bits == 16) {
+      ((uint16 *)brick)[i] = code;
+    } else {
+      const size_t ofs = (i * 3) >> 1;
+      if (i & 1) {
+        brick[ofs] = (brick[ofs] & 0x0f) | ((code & 0xf) << 4);
+        brick[ofs + 1] = code >> 4;
+      } else {
+        brick[ofs] = code & 0xff;
+        brick[ofs + 1] = (brick[ofs + 1] & 0xf0) | (code >> 8);
+      }
+    }
+  }
+
+  QuantizedBrickedVolume::QuantizedBrickedVolume() :
+    bitsPerVoxel(8),
+    numBricks(0),
+    voxels(nullptr),
+    brickDecode(nullptr)
+  {
+  }
+
+  QuantizedBrickedVolume::~QuantizedBrickedVolume()
+  {
+    for (size_t i = 0; i < pendingBricks.size(); i++)
+      delete pendingBricks[i];
+
+    alignedFree(voxels);
+    alignedFree(brickDecode);
+  }
+
+  std::string QuantizedBrickedVolume::toString() const
+  {
+    return("ospray::QuantizedBrickedVolume<" + voxelType + ">");
+  }
+
+  void QuantizedBrickedVolume::commit()
+  {
+    // Same as BlockBrickedVolume, the voxels are set before the first commit.
+    exitOnCondition(ispcEquivalent == nullptr,
+                    "the volume data must be set via ospSetRegion() "
+                    "prior to commit for this volume type");
+
+    // Quantize bricks that were only partially set.
+    parallel_for(numBricks, [&](int brickID){
+      if (pendingBricks[brickID])
+        quantizeBrick(brickID);
+    });
+
+    // Make the error bound visible to the application.
+    float quantizationError = 0.f;
+    for (size_t i = 0; i < numBricks; i++)
+      quantizationError = std::max(quantizationError, 0.5f * brickDecode[i].y);
+    set("quantizationError", quantizationError);
+
+    // StructuredVolume commit actions.
+    StructuredVolume::commit();
+  }
+
+  int QuantizedBrickedVolume::setRegion(
+      // points to the first voxel to be copied. The voxels at 'source' MUST
+      // have dimensions 'regionSize', must be organized in 3D-array order, and
+      // must have the same voxel type as the volume.
+      const void *source,
+      // coordinates of the lower, left, front corner of the target region
+      const vec3i &regionCoords,
+      // size of the region that we're writing to, MUST be the same as the
+      // dimensions of source[][][]
+      const vec3i &regionSize)
+  {
+    // Create the equivalent ISPC volume container and allocate memory for voxel
+    // data.
+    if (ispcEquivalent == nullptr)
+      createEquivalentISPC();
+
+    Assert2(source,"nullptr source in QuantizedBrickedVolume::setRegion()");
+
+#ifndef OSPRAY_VOLUME_VOXELRANGE_IN_APP
+    if (findParam("voxelRange") == nullptr) {
+      // Compute the voxel value range if none was previously specified.
+      const size_t numVoxelsInRegion
+        = (size_t)regionSize.x
+        * (size_t)regionSize.y
+        * (size_t)regionSize.z;
+      if (voxelType == "uchar")
+        computeVoxelRange((unsigned char *)source, numVoxelsInRegion);
+      else if (voxelType == "ushort")
+        computeVoxelRange((unsigned short *)source, numVoxelsInRegion);
+      else if (voxelType == "float")
+        computeVoxelRange((float *)source, numVoxelsInRegion);
+      else if (voxelType == "double")
+        computeVoxelRange((double *) source, numVoxelsInRegion);
+      set("voxelRange", voxelRange);
+    }
+#endif
+
+    streamRegion(source, regionCoords, regionSize,
+                 [&](const void *finalSource, const vec3i &finalRegionCoords,
+                     const vec3i &finalRegionSize){
+      if (voxelType == "uchar")
+        setRegion((const unsigned char *)finalSource, finalRegionCoords, finalRegionSize);
+      else if (voxelType == "ushort")
+        setRegion((const unsigned short *)finalSource, finalRegionCoords, finalRegionSize);
+      else if (voxelType == "float")
+        setRegion((const float *)finalSource, finalRegionCoords, finalRegionSize);
+      else
+        setRegion((const double *)finalSource, finalRegionCoords, finalRegionSize);
+    });
+
+    return true;
+  }
+
+  template<typename T>
+  void QuantizedBrickedVolume::setRegion(const T *source,
+                                         const vec3i &regionCoords,
+                                         const vec3i &regionSize)
+  {
+    // The bricks overlapping the region, each one is set by a single task.
+    const vec3i lower = max(regionCoords, vec3i(0)) / QUANTIZED_BRICK_WIDTH;
+    const vec3i upper = (min(regionCoords + regionSize, dimensions) - 1) / QUANTIZED_BRICK_WIDTH;
+    if (reduce_min(upper - lower) < 0)
+      return;
+
+    const vec3i count = upper - lower + 1;
+    parallel_for(count.x * count.y * count.z, [&](int taskIndex){
+      const vec3i index = lower + vec3i(taskIndex % count.x,
+                                        (taskIndex / count.x) % count.y,
+                                        taskIndex / (count.x * count.y));
+      const size_t brickID = index.x + brickCount.x *
+        (index.y + (size_t)brickCount.y * index.z);
+      setBrickRegion(brickID, source, regionCoords, regionSize);
+    });
+  }
+
+  template<typename T>
+  void QuantizedBrickedVolume::setBrickRegion(size_t brickID,
+                                              const T *source,
+                                              const vec3i &regionCoords,
+                                              const vec3i &regionSize)
+  {
+    PendingBrick *&pending = pendingBricks[brickID];
+    if (pending == nullptr) {
+      pending = new PendingBrick;
+
+      // A quantized brick is updated from its decoded voxels.
+      if (brickQuantized[brickID]) {
+        const vec2f decode = brickDecode[brickID];
+        const uint8 *brick = brickVoxels(brickID);
+        for (int i = 0; i < QUANTIZED_BRICK_VOXEL_COUNT; i++)
+          pending->values[i] = decode.x + decode.y * getCode(brick, bitsPerVoxel, i);
+        pending->isSet.set();
+        brickQuantized[brickID] = false;
+      }
+    }
+
+    const vec3i brickOrigin = brickIndex(brickID) * QUANTIZED_BRICK_WIDTH;
+    const vec3i lower = max(brickOrigin, regionCoords);
+    const vec3i upper = min(min(brickOrigin + QUANTIZED_BRICK_WIDTH,
+                                regionCoords + regionSize), dimensions);
+
+    for (int z = lower.z; z < upper.z; z++) {
+      for (int y = lower.y; y < upper.y; y++) {
+        const T *run = source + (lower.x - regionCoords.x) + regionSize.x *
+          ((y - regionCoords.y) + (size_t)regionSize.y * (z - regionCoords.z));
+        const int voxel = (lower.x - brickOrigin.x) + QUANTIZED_BRICK_WIDTH *
+          ((y - brickOrigin.y) + QUANTIZED_BRICK_WIDTH * (z - brickOrigin.z));
+        for (int x = 0; x < upper.x - lower.x; x++) {
+          pending->values[voxel + x] = run[x];
+          pending->isSet.set(voxel + x);
+        }
+      }
+    }
+
+    if ((int)pending->isSet.count() >= voxelsInBrick(brickID))
+      quantizeBrick(brickID);
+  }
+
+  void QuantizedBrickedVolume::quantizeBrick(size_t brickID)
+  {
+    PendingBrick *pending = pendingBricks[brickID];
+
+    // The value range of the voxels set so far, ignoring NaN values.
+    vec2f range(+INFINITY, -INFINITY);
+    for (int i = 0; i < QUANTIZED_BRICK_VOXEL_COUNT; i++) {
+      if (pending->isSet[i] && !std::isnan(pending->values[i])) {
+        range.x = std::min(range.x, pending->values[i]);
+        range.y = std::max(range.y, pending->values[i]);
+      }
+    }
+    if (range.x > range.y)
+      range = vec2f(0.f);
+
+    // Voxels that were never set (or NaN) decode to the brick minimum.
+    const float maxCode = (1 << bitsPerVoxel) - 1;
+    const float step = (range.y - range.x) / maxCode;
+    const float rcpStep = step > 0.f ? 1.f / step : 0.f;
+    uint8 *brick = brickVoxels(brickID);
+    for (int i = 0; i < QUANTIZED_BRICK_VOXEL_COUNT; i++) {
+      float code = 0.f;
+      if (pending->isSet[i] && !std::isnan(pending->values[i])) {
+        code = std::min(std::floor((pending->values[i] - range.x) * rcpStep + 0.5f),
+                        maxCode);
+      }
+      setCode(brick, bitsPerVoxel, i, (uint32)code);
+    }
+
+    brickDecode[brickID] = vec2f(range.x, step);
+    brickQuantized[brickID] = true;
+
+    delete pending;
+    pendingBricks[brickID] = nullptr;
+  }
+
+  vec3i QuantizedBrickedVolume::brickIndex(size_t brickID) const
+  {
+    return vec3i(brickID % brickCount.x,
+                 (brickID / brickCount.x) % brickCount.y,
+                 brickID / ((size_t)brickCount.x * brickCount.y));
+  }
+
+  uint8 *QuantizedBrickedVolume::brickVoxels(size_t brickID) const
+  {
+    return (uint8 *)voxels
+      + brickID * (QUANTIZED_BRICK_VOXEL_COUNT * bitsPerVoxel / 8);
+  }
+
+  int QuantizedBrickedVolume::voxelsInBrick(size_t brickID) const
+  {
+    const vec3i size = min(dimensions - brickIndex(brickID) * QUANTIZED_BRICK_WIDTH,
+                           vec3i(QUANTIZED_BRICK_WIDTH));
+    return size.x * size.y * size.z;
+  }
+
+  void QuantizedBrickedVolume::createEquivalentISPC()
+  {
+    // Get the voxel type.
+    voxelType = getParamString("voxelType", "unspecified");
+    exitOnCondition(getVoxelType() != OSP_UCHAR &&
+                    getVoxelType() != OSP_USHORT &&
+                    getVoxelType() != OSP_FLOAT &&
+                    getVoxelType() != OSP_DOUBLE,
+                    "unrecognized voxel type (must be set before "
+                    "calling ospSetRegion())");
+
+    // Get the volume dimensions.
+    this->dimensions = getParam3i("dimensions", vec3i(0));
+    exitOnCondition(reduce_min(this->dimensions) <= 0,
+                    "invalid volume dimensions (must be set before "
+                    "calling ospSetRegion())");
+
+    bitsPerVoxel = getParam1i("bitsPerVoxel", 8);
+    exitOnCondition(bitsPerVoxel != 8 && bitsPerVoxel != 12 && bitsPerVoxel != 16,
+                    "bitsPerVoxel must be 8, 12 or 16");
+
+    // Allocate the quantized voxels, bricks never set decode to zero.
+    brickCount = (dimensions + QUANTIZED_BRICK_WIDTH - 1) / QUANTIZED_BRICK_WIDTH;
+    numBricks = (size_t)brickCount.x * brickCount.y * brickCount.z;
+
+    const size_t voxelBytes = numBricks * QUANTIZED_BRICK_VOXEL_COUNT * bitsPerVoxel / 8;
+    voxels = alignedMalloc(voxelBytes);
+    brickDecode = (vec2f *)alignedMalloc(numBricks * sizeof(vec2f));
+    exitOnCondition(voxels == nullptr || brickDecode == nullptr,
+                    "failed to allocate quantized volume memory");
+    memset(voxels, 0, voxelBytes);
+    std::fill(brickDecode, brickDecode + numBricks, vec2f(0.f));
+
+    pendingBricks.assign(numBricks, nullptr);
+    brickQuantized.assign(numBricks, false);
+
+    // Create an ISPC QuantizedBrickedVolume object and assign type-specific
+    // function pointers.
+    ispcEquivalent = ispc::QuantizedBrickedVolume_createInstance(this,
+                                         bitsPerVoxel,
+                                         (const ispc::vec3i &)this->dimensions,
+                                         (const ispc::vec3i &)brickCount,
+                                         voxels,
+                                         brickDecode);
+  }
+
+  // A volume type storing bricks of voxels quantized to 8, 12 or 16 bits.
+  OSP_REGISTER_VOLUME(QuantizedBrickedVolume, quantized_bricked_volume);
+
+} // ::ospray
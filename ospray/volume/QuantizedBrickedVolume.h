@@ -0,0 +1,135 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+#include "volume/StructuredVolume.h"
+// std
+#include <bitset>
+#include <vector>
+
+//! Width of a quantized brick in voxels, must match BRICK_WIDTH in
+//! QuantizedBrickedVolume.ispc.
+#define QUANTIZED_BRICK_WIDTH (8)
+
+//! The number of voxels in a quantized brick.
+#define QUANTIZED_BRICK_VOXEL_COUNT \
+  (QUANTIZED_BRICK_WIDTH * QUANTIZED_BRICK_WIDTH * QUANTIZED_BRICK_WIDTH)
+
+namespace ospray {
+
+  //! \brief A concrete implementation of the StructuredVolume class
+  //!  which stores the voxels of each brick quantized to 8, 12 or 16 bits.
+  //!
+  //!  The volume is split into 8^3 voxel bricks. A brick stores its voxels
+  //!  as 'bitsPerVoxel' (8, 12 or 16, default 8) bit codes q along with the
+  //!  minimum and the quantization step of the brick, and the sampling
+  //!  kernels decode value = minimum + step * q. Codes are rounded to the
+  //!  nearest, so the error of a voxel is at most half a step, that is
+  //!  (brick maximum - brick minimum) / (2 * (2^bitsPerVoxel - 1)). The
+  //!  largest such bound over all bricks is made visible to the
+  //!  application as the 'quantizationError' parameter on commit.
+  //!
+  //!  12 bit codes are packed two voxels to three bytes, so a volume takes
+  //!  about 1.02, 1.52 or 2.02 bytes per voxel (including the 8 bytes per
+  //!  brick for minimum and step), against 4 for float voxels.
+  //!
+  //!  A ZFP-style transform coder is not provided: it decodes whole 4^3
+  //!  blocks at a time, which does not fit the per-lane voxel gathers the
+  //!  sampling kernels use, and would need a decoded brick cache.
+  //!
+  //!  Voxels of any of the usual voxel types are set with ospSetRegion().
+  //!  A brick is kept in float until all its voxels have been set (or the
+  //!  volume is committed), and quantized then.
+  //!
+  class QuantizedBrickedVolume : public StructuredVolume {
+  public:
+
+    QuantizedBrickedVolume();
+    ~QuantizedBrickedVolume();
+
+    //! A string description of this class.
+    std::string toString() const override;
+
+    //! Quantize the remaining bricks, called through the OSPRay API.
+    void commit() override;
+
+    //! Copy voxels into the volume at the given index (non-zero return value
+    //!  indicates success).
+    int setRegion(const void *source,
+                  const vec3i &index,
+                  const vec3i &count) override;
+
+  private:
+
+    //! A brick that has not been quantized yet.
+    struct PendingBrick {
+      float values[QUANTIZED_BRICK_VOXEL_COUNT];
+      std::bitset<QUANTIZED_BRICK_VOXEL_COUNT> isSet;
+    };
+
+    //! Create the equivalent ISPC volume container.
+    void createEquivalentISPC() override;
+
+    //! Copy the part of the region inside the given brick into the brick.
+    template<typename T>
+    void setBrickRegion(size_t brickID,
+                        const T *source,
+                        const vec3i &regionCoords,
+                        const vec3i &regionSize);
+
+    //! Copy voxels into the bricks overlapping the region.
+    template<typename T>
+    void setRegion(const T *source,
+                   const vec3i &regionCoords,
+                   const vec3i &regionSize);
+
+    //! Quantize a pending brick and release its float voxels.
+    void quantizeBrick(size_t brickID);
+
+    //! The quantized voxels of a brick.
+    uint8 *brickVoxels(size_t brickID) const;
+
+    //! 3D index of a brick.
+    vec3i brickIndex(size_t brickID) const;
+
+    //! Number of voxels of a brick inside the volume.
+    int voxelsInBrick(size_t brickID) const;
+
+    //! Bits per quantized voxel.
+    int bitsPerVoxel;
+
+    //! Volume size in bricks per dimension.
+    vec3i brickCount;
+
+    //! Number of bricks.
+    size_t numBricks;
+
+    //! Quantized voxels, brick after brick.
+    void *voxels;
+
+    //! Minimum and quantization step of each brick.
+    vec2f *brickDecode;
+
+    //! Bricks not yet quantized, or nullptr.
+    std::vector<PendingBrick *> pendingBricks;
+
+    //! Whether a brick has been quantized since it was last set.
+    std::vector<unsigned char> brickQuantized;
+  };
+
+} // ::ospray
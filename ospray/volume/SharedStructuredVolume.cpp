@@ -51,6 +51,7 @@ SharedStructuredVolume::~SharedStructuredVolume()
   {
     if (getIE() == nullptr)
       createEquivalentISPC();
+    markRegionDirty(index, count);
     switch (getVoxelType()) {
     case OSP_UCHAR:
       ispc::SharedStructuredVolume_setRegion_uint8(getIE(),source,
@@ -124,8 +125,12 @@ SharedStructuredVolume::~SharedStructuredVolume()
   void SharedStructuredVolume::dependencyGotChanged(ManagedObject *object)
   {
     // Rebuild volume accelerator when voxelData is committed.
-    if(object == voxelData && ispcEquivalent)
+    if(object == voxelData && ispcEquivalent) {
       StructuredVolume::buildAccelerator();
+      classifyAccelerator();
+    } else {
+      StructuredVolume::dependencyGotChanged(object);
+    }
   }
 
   // A volume type with XYZ storage order. The voxel data is provided by the
@@ -20,6 +20,7 @@
 #include "common/Library.h"
 #include "volume/StructuredVolume.h"
 #include "GridAccelerator_ispc.h"
+#include "MarchingCubes_ispc.h"
 #include "StructuredVolume_ispc.h"
 
 // stl
@@ -28,12 +29,18 @@
 namespace ospray {
 
   StructuredVolume::StructuredVolume() :
+    gridOrigin(0.f),
+    gridSpacing(1.f),
     finished(false),
     voxelRange(FLT_MAX, -FLT_MAX)
   {
   }
 
-  StructuredVolume::~StructuredVolume() {}
+  StructuredVolume::~StructuredVolume()
+  {
+    if (classifiedTransferFunction)
+      classifiedTransferFunction->unregisterListener(this);
+  }
 
   std::string StructuredVolume::toString() const
   {
@@ -46,6 +53,10 @@ namespace ospray {
     // filled.
     updateEditableParameters();
 
+    // Isosurface meshes are extracted in world coordinates.
+    const vec3f previousGridOrigin = this->gridOrigin;
+    const vec3f previousGridSpacing = this->gridSpacing;
+
     // Set the grid origin, default to (0,0,0).
     this->gridOrigin = getParam3f("gridOrigin", vec3f(0.f));
 
@@ -60,56 +71,60 @@ namespace ospray {
 
     this->scaleFactor = getParam3f("scaleFactor", vec3f(-1.f));
 
+    if (previousGridOrigin != this->gridOrigin
+        || previousGridSpacing != this->gridSpacing)
+      clearIsosurfaceCache();
+
     ispc::StructuredVolume_setGridOrigin(ispcEquivalent,
                                          (const ispc::vec3f&)this->gridOrigin);
     ispc::StructuredVolume_setGridSpacing(ispcEquivalent,
                                          (const ispc::vec3f&)this->gridSpacing);
 
-    // Complete volume initialization (only on first commit).
+    // Listen to changes of the transfer function, which require the
+    // accelerator cells to be reclassified.
+    ManagedObject *transferFunction = getParamObject("transferFunction", NULL);
+    const bool transferFunctionChanged
+      = transferFunction != classifiedTransferFunction.ptr;
+    if (transferFunctionChanged) {
+      if (classifiedTransferFunction)
+        classifiedTransferFunction->unregisterListener(this);
+      classifiedTransferFunction = transferFunction;
+      if (transferFunction)
+        transferFunction->registerListener(this);
+    }
+
+    // Complete volume initialization (only on first commit), afterwards only
+    // the parts of the accelerator affected by changes get updated.
     if (!finished) {
       finish();
       finished = true;
+    } else {
+      updateAccelerator();
+      if (transferFunctionChanged)
+        classifyAccelerator();
     }
   }
 
-  bool StructuredVolume::scaleRegion(const void *source, void *&out, vec3i &regionSize, vec3i &regionCoords){
-    this->scaleFactor = getParam3f("scaleFactor", vec3f(-1.f));
-    const bool upsampling = scaleFactor.x > 0 && scaleFactor.y > 0 && scaleFactor.z > 0;
-    vec3i scaledRegionSize = vec3i(scaleFactor * vec3f(regionSize));
-    vec3i scaledRegionCoords = vec3i(scaleFactor * vec3f(regionCoords));
-
-    if (upsampling) {
-      if (voxelType == "uchar") {
-        out = malloc(sizeof(unsigned char) * size_t(scaledRegionSize.x) *
-            size_t(scaledRegionSize.y) * size_t(scaledRegionSize.z));
-        upsampleRegion((unsigned char *)source, (unsigned char *)out, regionSize, scaledRegionSize);
-      }
-      else if (voxelType == "ushort") {
-        out = malloc(sizeof(unsigned short) * size_t(scaledRegionSize.x) *
-            size_t(scaledRegionSize.y) * size_t(scaledRegionSize.z));
-        upsampleRegion((unsigned short *)source, (unsigned short *)out, regionSize, scaledRegionSize);
-      }
-      else if (voxelType == "float") {
-        out = malloc(sizeof(float) * size_t(scaledRegionSize.x) *
-            size_t(scaledRegionSize.y) * size_t(scaledRegionSize.z));
-        upsampleRegion((float *)source, (float *)out, regionSize, scaledRegionSize);
-      }
-      else if (voxelType == "double") {
-        out = malloc(sizeof(double) * size_t(scaledRegionSize.x) *
-            size_t(scaledRegionSize.y) * size_t(scaledRegionSize.z));
-        upsampleRegion((double *)source, (double *)out, regionSize, scaledRegionSize);
-      }
-      regionSize = scaledRegionSize;
-      regionCoords = scaledRegionCoords;
-    }
-    return upsampling;
+  void StructuredVolume::dependencyGotChanged(ManagedObject *object)
+  {
+    if (object == classifiedTransferFunction.ptr && finished)
+      classifyAccelerator();
   }
 
   void StructuredVolume::buildAccelerator()
   {
+    clearIsosurfaceCache();
+
     // Create instance of volume accelerator.
     void *accel = ispc::StructuredVolume_createAccelerator(ispcEquivalent);
 
+    // The cell value ranges may already be known from setting the voxels.
+    if (!cellRanges.empty()) {
+      setAcceleratorCellRanges(accel, cellRanges.data());
+      buildMacrocellLevels(accel);
+      return;
+    }
+
     vec3i brickCount;
     brickCount.x = ispc::GridAccelerator_getBrickCount_x(accel);
     brickCount.y = ispc::GridAccelerator_getBrickCount_y(accel);
@@ -120,6 +135,173 @@ namespace ospray {
     parallel_for(NTASKS, [&](int taskIndex){
       ispc::GridAccelerator_buildAccelerator(ispcEquivalent, taskIndex);
     });
+
+    buildMacrocellLevels(accel);
+  }
+
+  void StructuredVolume::setAcceleratorCellRanges(void *accel,
+                                                  const vec2f *ranges)
+  {
+    const vec3i gridDimensions
+      = (dimensions + STRUCTURED_VOLUME_CELL_WIDTH - 1)
+      / STRUCTURED_VOLUME_CELL_WIDTH;
+    parallel_for(gridDimensions.z, [&](int taskIndex){
+      ispc::GridAccelerator_setCellRanges(accel, (const ispc::vec2f *)ranges,
+                                          taskIndex);
+    });
+  }
+
+  void StructuredVolume::markRegionDirty(const vec3i &regionCoords,
+                                         const vec3i &regionSize)
+  {
+    // Before the first commit the accelerator is built from all voxels.
+    if (!finished)
+      return;
+
+    clearIsosurfaceCache();
+
+    const vec3i lower = max(regionCoords, vec3i(0));
+    const vec3i upper = min(regionCoords + regionSize, dimensions);
+    if (reduce_min(upper - lower) <= 0)
+      return;
+
+    dirtyCells.push_back(box3i(lower / STRUCTURED_VOLUME_CELL_WIDTH,
+                               (upper - 1) / STRUCTURED_VOLUME_CELL_WIDTH + 1));
+  }
+
+  void StructuredVolume::updateAccelerator()
+  {
+    void *accel = ispc::StructuredVolume_getAccelerator(ispcEquivalent);
+    if (accel == nullptr || dirtyCells.empty()) {
+      dirtyCells.clear();
+      return;
+    }
+
+    // Cell ranges tracked while copying the voxels are used as they are,
+    // otherwise the voxels of the dirty cells get scanned.
+    const vec2f *ranges = cellRanges.empty() ? nullptr : cellRanges.data();
+    for (const box3i &cells : dirtyCells) {
+      parallel_for(cells.upper.z - cells.lower.z, [&](int taskIndex){
+        ispc::GridAccelerator_updateCells(ispcEquivalent,
+                                          (const ispc::vec2f *)ranges,
+                                          (const ispc::vec3i &)cells.lower,
+                                          (const ispc::vec3i &)cells.upper,
+                                          taskIndex);
+      });
+    }
+
+    buildMacrocellLevels(accel);
+
+    for (const box3i &cells : dirtyCells)
+      classifyCells(accel, cells);
+    classifyMacrocellLevels(accel);
+
+    dirtyCells.clear();
+  }
+
+  void StructuredVolume::classifyAccelerator()
+  {
+    void *accel = ispc::StructuredVolume_getAccelerator(ispcEquivalent);
+    if (accel == nullptr)
+      return;
+
+    const vec3i gridDimensions
+      = (dimensions + STRUCTURED_VOLUME_CELL_WIDTH - 1)
+      / STRUCTURED_VOLUME_CELL_WIDTH;
+    classifyCells(accel, box3i(vec3i(0), gridDimensions));
+    classifyMacrocellLevels(accel);
+  }
+
+  void StructuredVolume::classifyCells(void *accel, const box3i &cells)
+  {
+    parallel_for(cells.upper.z - cells.lower.z, [&](int taskIndex){
+      ispc::GridAccelerator_classifyCells(accel,
+                                          (const ispc::vec3i &)cells.lower,
+                                          (const ispc::vec3i &)cells.upper,
+                                          taskIndex);
+    });
+  }
+
+  void StructuredVolume::classifyMacrocellLevels(void *accel)
+  {
+    const int levelCount = ispc::GridAccelerator_getLevelCount(accel);
+    for (int level = 1; level <= levelCount; level++) {
+      const int slices = ispc::GridAccelerator_getLevelDimensions_z(accel, level);
+      parallel_for(slices, [&](int taskIndex){
+        ispc::GridAccelerator_classifyMacrocellLevel(accel, level, taskIndex);
+      });
+    }
+  }
+
+  void StructuredVolume::buildMacrocellLevels(void *accel)
+  {
+    // Build the macrocell levels on top of the grid cells, bottom up.
+    const int levelCount = ispc::GridAccelerator_getLevelCount(accel);
+    for (int level = 1; level <= levelCount; level++) {
+      const int slices = ispc::GridAccelerator_getLevelDimensions_z(accel, level);
+      parallel_for(slices, [&](int taskIndex){
+        ispc::GridAccelerator_buildMacrocellLevel(accel, level, taskIndex);
+      });
+    }
+  }
+
+  std::shared_ptr<const StructuredVolume::IsosurfaceMesh>
+  StructuredVolume::getIsosurfaceMesh(float isovalue)
+  {
+    std::lock_guard<std::mutex> lock(isosurfaceCacheMutex);
+
+    auto cached = isosurfaceCache.find(isovalue);
+    if (cached != isosurfaceCache.end())
+      return cached->second;
+
+    if (ispc::StructuredVolume_getAccelerator(ispcEquivalent) == nullptr)
+      throw std::runtime_error(toString() + " has no accelerator to extract"
+                               " isosurfaces with");
+
+    // Count the triangles of each brick first, so that every brick writes
+    // its triangles to its own part of the mesh.
+    const int brickCount = ispc::MarchingCubes_getBrickCount(ispcEquivalent);
+    std::vector<int64> firstTriangle(brickCount + 1, 0);
+    parallel_for(brickCount, [&](int taskIndex){
+      firstTriangle[taskIndex + 1]
+        = ispc::MarchingCubes_countTriangles(ispcEquivalent, isovalue, taskIndex);
+    });
+    for (int i = 0; i < brickCount; i++)
+      firstTriangle[i + 1] += firstTriangle[i];
+
+    // Triangle meshes index their vertices with int32.
+    const int64 triangleCount = firstTriangle[brickCount];
+    if (3 * triangleCount > std::numeric_limits<int32>::max())
+      throw std::runtime_error("isosurface of " + toString()
+                               + " has too many triangles for a triangle mesh");
+
+    std::shared_ptr<IsosurfaceMesh> mesh = std::make_shared<IsosurfaceMesh>();
+    mesh->vertex.resize(3 * triangleCount);
+    mesh->normal.resize(3 * triangleCount);
+    parallel_for(brickCount, [&](int taskIndex){
+      ispc::MarchingCubes_extractTriangles(ispcEquivalent, isovalue, taskIndex,
+                                           firstTriangle[taskIndex],
+                                           (ispc::vec3fa *)mesh->vertex.data(),
+                                           (ispc::vec3fa *)mesh->normal.data());
+    });
+
+    // Meshes of other isovalues no geometry uses anymore are dropped, so
+    // sweeping the isovalue does not accumulate meshes.
+    for (auto it = isosurfaceCache.begin(); it != isosurfaceCache.end(); ) {
+      if (it->second.use_count() == 1)
+        it = isosurfaceCache.erase(it);
+      else
+        ++it;
+    }
+
+    isosurfaceCache[isovalue] = mesh;
+    return mesh;
+  }
+
+  void StructuredVolume::clearIsosurfaceCache()
+  {
+    std::lock_guard<std::mutex> lock(isosurfaceCacheMutex);
+    isosurfaceCache.clear();
   }
 
   void StructuredVolume::finish()
@@ -131,6 +313,7 @@ namespace ospray {
       voxelRange = getParam2f("voxelRange", voxelRange);
 
     buildAccelerator();
+    classifyAccelerator();
 
     // Volume finish actions.
     Volume::finish();
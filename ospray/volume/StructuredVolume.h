@@ -21,7 +21,19 @@
 #include "volume/Volume.h"
 // stl
 #include <algorithm>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+
+//! Width of an accelerator cell in voxels, must match CELL_WIDTH in
+//! GridAccelerator.ispc.
+#define STRUCTURED_VOLUME_CELL_WIDTH (16)
+
+//! Upper bound on the size of the slabs a scaled region is produced in.
+#define STRUCTURED_VOLUME_MAX_SLAB_BYTES (64*1024*1024)
 
 namespace ospray {
 
@@ -57,6 +69,19 @@ namespace ospray {
                           const vec3i &target_index,
                           const vec3i &source_count) override = 0;
 
+    //! Triangles of an isosurface, three consecutive vertices per triangle,
+    //! in world coordinates.
+    struct IsosurfaceMesh {
+      std::vector<vec3fa> vertex;
+      std::vector<vec3fa> normal;
+    };
+
+    /*! Extract the isosurface at the given value with marching cubes, in
+        parallel over the bricks of the accelerator and skipping grid cells
+        whose value range excludes the isovalue. Meshes are cached per
+        isovalue until the voxels or the grid of the volume change. */
+    std::shared_ptr<const IsosurfaceMesh> getIsosurfaceMesh(float isovalue);
+
   protected:
 
     //! Create the equivalent ISPC volume container.
@@ -70,20 +95,70 @@ namespace ospray {
     void computeVoxelRange(const T* source, const size_t &count);
 #endif
 
+    /*! Upsample the slices [zBegin, zBegin+zCount) of the scaled region into
+        'out', which holds zCount slices of scaledRegionSize. */
     template<typename T>
-    void upsampleRegion(const T *source, T *out, const vec3i &regionSize, const vec3i &scaledRegionSize);
+    void upsampleRegion(const T *source, T *out, const vec3i &regionSize, const vec3i &scaledRegionSize,
+                        int zBegin, int zCount);
 
-    /*! Scale up the region we're setting in ospSetRegion. Will return the scaled region size and coordinates
-        through the regionSize and regionCoords passed for the unscaled region (from ospSetRegion),
-        and return true if we actually upsampled the data. If we upsample the data the caller
-        is responsible for calling free on the out data parameter to release the scaled volume data.
-     */
-    bool scaleRegion(const void *source, void *&out, vec3i &regionSize, vec3i &regionCoords);
+    /*! Pass the region we're setting in ospSetRegion to copyRegion(source,
+        regionCoords, regionSize), scaled up by 'scaleFactor' if that is set.
+        Scaled regions are produced and passed on in z-slabs of bounded size,
+        so no copy of the whole scaled region is made. */
+    template<typename COPY_REGION_T>
+    void streamRegion(const void *source, const vec3i &regionCoords, const vec3i &regionSize,
+                      const COPY_REGION_T &copyRegion);
+
+    /*! Copy a region in parallel by calling copyRow(rowIndex) for each x-row
+        (y + regionSize.y * z) of the region inside the volume. Rows are
+        processed grouped by accelerator cells, so the value ranges of the
+        cells and of the volume are accumulated from the rows while they
+        are still in cache. */
+    template<typename COPY_ROW_T>
+    void copyRegionRows(const void *source, const vec3i &regionCoords, const vec3i &regionSize,
+                        const COPY_ROW_T &copyRow);
+
+    template<typename T, typename COPY_ROW_T>
+    void copyRegionRows(const T *source, const vec3i &regionCoords, const vec3i &regionSize,
+                        const COPY_ROW_T &copyRow);
+
+    //! Fill the grid cells of an accelerator from value ranges given per cell
+    //! in x-fastest order, instead of computing them from the voxels.
+    void setAcceleratorCellRanges(void *accel, const vec2f *ranges);
 
     //! build the accelerator - allows child class (data distributed) to avoid
     //! building..
     virtual void buildAccelerator();
 
+    //! Build the macrocell levels of the given accelerator once the value
+    //! ranges of its grid cells are known.
+    void buildMacrocellLevels(void *accel);
+
+    /*! Remember that the voxels of a region changed after the accelerator
+        was built, so the next commit re-encodes the grid cells covering
+        them (instead of rebuilding the whole accelerator). */
+    void markRegionDirty(const vec3i &regionCoords, const vec3i &regionSize);
+
+    //! Re-encode the grid cells of the accelerator marked dirty since the
+    //! last commit, and the macrocell levels above them.
+    void updateAccelerator();
+
+    //! Classify all (macro)cells of the accelerator as visible or fully
+    //! transparent under the current transfer function.
+    void classifyAccelerator();
+
+    //! Classify the grid cells in the box of cells, without the macrocells.
+    void classifyCells(void *accel, const box3i &cells);
+
+    //! Classify the macrocell levels, once their value ranges are known.
+    void classifyMacrocellLevels(void *accel);
+
+    //! Drop the cached isosurface meshes.
+    void clearIsosurfaceCache();
+
+    //! Reclassify the accelerator when the transfer function gets committed.
+    virtual void dependencyGotChanged(ManagedObject *object) override;
+
     //! Get the OSPDataType enum corresponding to the voxel type string.
     OSPDataType getVoxelType();
 
@@ -105,6 +180,26 @@ namespace ospray {
     //! Voxel type.
     std::string voxelType;
 
+    /*! Value range of each accelerator cell (x fastest) of the voxels set
+        through copyRegionRows(), used instead of scanning the volume when
+        the accelerator is built. */
+    std::vector<vec2f> cellRanges;
+
+    //! Boxes of grid cells (upper bound exclusive) whose voxels changed
+    //! after the accelerator was built.
+    std::vector<box3i> dirtyCells;
+
+    /*! The transfer function the accelerator is classified for. The volume
+        listens to it, so editing the transfer function only reclassifies
+        the cells and never touches the voxels. */
+    Ref<ManagedObject> classifiedTransferFunction;
+
+    //! Isosurface meshes extracted from the current voxels, by isovalue.
+    std::map<float, std::shared_ptr<const IsosurfaceMesh>> isosurfaceCache;
+
+    //! Guards the isosurface cache.
+    std::mutex isosurfaceCacheMutex;
+
     /*! Scale factor for the volume, mostly for internal use or data scaling benchmarking.
        Note that this must be set **before** calling 'ospSetRegion' on the volume as the
        scaling is applied in that function.
@@ -144,16 +239,186 @@ namespace ospray {
   }
 #endif
   template<typename T>
-  void StructuredVolume::upsampleRegion(const T *source, T *out, const vec3i &regionSize, const vec3i &scaledRegionSize){
-    for (size_t z = 0; z < scaledRegionSize.z; ++z){
-      parallel_for(scaledRegionSize.x * scaledRegionSize.y, [&](int taskID){
-        int x = taskID % scaledRegionSize.x;
-        int y = taskID / scaledRegionSize.x;
-        const int idx = static_cast<int>(z / scaleFactor.z) * regionSize.x * regionSize.y
-            + static_cast<int>(y / scaleFactor.y) * regionSize.x + static_cast<int>(x / scaleFactor.x);
-        out[z * scaledRegionSize.y * scaledRegionSize.x + y * scaledRegionSize.x + x] = source[idx];
-      });
+  inline void StructuredVolume::upsampleRegion(const T *source, T *out,
+                                               const vec3i &regionSize,
+                                               const vec3i &scaledRegionSize,
+                                               int zBegin, int zCount)
+  {
+    parallel_for(zCount * scaledRegionSize.y, [&](int taskID){
+      const int y = taskID % scaledRegionSize.y;
+      const int z = zBegin + taskID / scaledRegionSize.y;
+      const T *sourceRow = source
+        + static_cast<int>(z / scaleFactor.z) * size_t(regionSize.x) * regionSize.y
+        + static_cast<int>(y / scaleFactor.y) * size_t(regionSize.x);
+      T *outRow = out + size_t(taskID) * scaledRegionSize.x;
+      for (int x = 0; x < scaledRegionSize.x; ++x)
+        outRow[x] = sourceRow[static_cast<int>(x / scaleFactor.x)];
+    });
+  }
+
+  template<typename COPY_REGION_T>
+  inline void StructuredVolume::streamRegion(const void *source,
+                                             const vec3i &regionCoords,
+                                             const vec3i &regionSize,
+                                             const COPY_REGION_T &copyRegion)
+  {
+    this->scaleFactor = getParam3f("scaleFactor", vec3f(-1.f));
+    const bool upsampling = scaleFactor.x > 0 && scaleFactor.y > 0 && scaleFactor.z > 0;
+    if (!upsampling) {
+      markRegionDirty(regionCoords, regionSize);
+      copyRegion(source, regionCoords, regionSize);
+      return;
+    }
+
+    const vec3i scaledRegionSize = vec3i(scaleFactor * vec3f(regionSize));
+    const vec3i scaledRegionCoords = vec3i(scaleFactor * vec3f(regionCoords));
+    if (reduce_min(scaledRegionSize) <= 0)
+      return;
+
+    const size_t sliceBytes = sizeOf(getVoxelType())
+      * size_t(scaledRegionSize.x) * size_t(scaledRegionSize.y);
+    const int slabSlices = std::min<size_t>(scaledRegionSize.z,
+        std::max<size_t>(1, STRUCTURED_VOLUME_MAX_SLAB_BYTES / sliceBytes));
+    void *slab = malloc(sliceBytes * slabSlices);
+    exitOnCondition(slab == nullptr, "failed to allocate upsampling buffer");
+
+    for (int z = 0; z < scaledRegionSize.z; z += slabSlices) {
+      const int slices = std::min(slabSlices, scaledRegionSize.z - z);
+      if (voxelType == "uchar")
+        upsampleRegion((const unsigned char *)source, (unsigned char *)slab,
+                       regionSize, scaledRegionSize, z, slices);
+      else if (voxelType == "ushort")
+        upsampleRegion((const unsigned short *)source, (unsigned short *)slab,
+                       regionSize, scaledRegionSize, z, slices);
+      else if (voxelType == "float")
+        upsampleRegion((const float *)source, (float *)slab,
+                       regionSize, scaledRegionSize, z, slices);
+      else if (voxelType == "double")
+        upsampleRegion((const double *)source, (double *)slab,
+                       regionSize, scaledRegionSize, z, slices);
+
+      const vec3i slabCoords = scaledRegionCoords + vec3i(0, 0, z);
+      const vec3i slabSize(scaledRegionSize.x, scaledRegionSize.y, slices);
+      markRegionDirty(slabCoords, slabSize);
+      copyRegion(slab, slabCoords, slabSize);
     }
+
+    free(slab);
+  }
+
+  template<typename COPY_ROW_T>
+  inline void StructuredVolume::copyRegionRows(const void *source,
+                                               const vec3i &regionCoords,
+                                               const vec3i &regionSize,
+                                               const COPY_ROW_T &copyRow)
+  {
+    if (voxelType == "uchar")
+      copyRegionRows((const unsigned char *)source, regionCoords, regionSize, copyRow);
+    else if (voxelType == "ushort")
+      copyRegionRows((const unsigned short *)source, regionCoords, regionSize, copyRow);
+    else if (voxelType == "float")
+      copyRegionRows((const float *)source, regionCoords, regionSize, copyRow);
+    else if (voxelType == "double")
+      copyRegionRows((const double *)source, regionCoords, regionSize, copyRow);
+    else
+      throw std::runtime_error("invalid voxelType in " + toString() + "::setRegion()");
   }
+
+  template<typename T, typename COPY_ROW_T>
+  inline void StructuredVolume::copyRegionRows(const T *source,
+                                               const vec3i &regionCoords,
+                                               const vec3i &regionSize,
+                                               const COPY_ROW_T &copyRow)
+  {
+    const int cellWidth = STRUCTURED_VOLUME_CELL_WIDTH;
+    const vec3i gridDimensions = (dimensions + cellWidth - 1) / cellWidth;
+    if (cellRanges.empty()) {
+      // Same sentinel as GridAccelerator_encodeBrickCell().
+      cellRanges.assign(size_t(gridDimensions.x) * gridDimensions.y * gridDimensions.z,
+                        vec2f(99999.0f, -99999.0f));
+    }
+
+    // The part of the region inside the volume, and the cells it touches.
+    const vec3i lower = max(regionCoords, vec3i(0));
+    const vec3i upper = min(regionCoords + regionSize, dimensions);
+    if (reduce_min(upper - lower) <= 0)
+      return;
+
+    const vec3i cellLower = lower / cellWidth;
+    const vec3i cellCount = (upper - 1) / cellWidth - cellLower + 1;
+
+    // Each task copies the rows of one row of cells, and owns those cells.
+    const int numTasks = cellCount.y * cellCount.z;
+    std::vector<vec2f> taskRange(numTasks);
+
+    parallel_for(numTasks, [&](int taskIndex){
+      const vec3i cell(cellLower.x,
+                       cellLower.y + taskIndex % cellCount.y,
+                       cellLower.z + taskIndex / cellCount.y);
+      vec2f *rowCellRange = STACK_BUFFER(vec2f, cellCount.x);
+      for (int i = 0; i < cellCount.x; i++)
+        rowCellRange[i] = vec2f(+INFINITY, -INFINITY);
+
+      const int zEnd = std::min(upper.z, (cell.z + 1) * cellWidth);
+      const int yEnd = std::min(upper.y, (cell.y + 1) * cellWidth);
+      for (int z = std::max(lower.z, cell.z * cellWidth); z < zEnd; z++) {
+        for (int y = std::max(lower.y, cell.y * cellWidth); y < yEnd; y++) {
+          const int row = (y - regionCoords.y) + regionSize.y * (z - regionCoords.z);
+          copyRow(row);
+
+          const T *run = source + size_t(regionSize.x) * row - regionCoords.x;
+          for (int i = 0; i < cellCount.x; i++) {
+            vec2f &range = rowCellRange[i];
+            const int xEnd = std::min(upper.x, (cellLower.x + i + 1) * cellWidth);
+            for (int x = std::max(lower.x, (cellLower.x + i) * cellWidth); x < xEnd; x++) {
+              // Ignore NaN values, as the accelerator does.
+              const float value = run[x];
+              if (!std::isnan(value)) {
+                range.x = std::min(range.x, value);
+                range.y = std::max(range.y, value);
+              }
+            }
+          }
+        }
+      }
+
+      // Cells the region covers completely get their range replaced, so
+      // that overwriting voxels can also shrink it. The ranges of partially
+      // covered cells can only grow.
+      const bool coversYZ
+        = lower.y <= cell.y * cellWidth
+        && upper.y >= std::min(dimensions.y, (cell.y + 1) * cellWidth)
+        && lower.z <= cell.z * cellWidth
+        && upper.z >= std::min(dimensions.z, (cell.z + 1) * cellWidth);
+
+      vec2f myRange(+INFINITY, -INFINITY);
+      for (int i = 0; i < cellCount.x; i++) {
+        const int cx = cell.x + i;
+        const bool covers = coversYZ
+          && lower.x <= cx * cellWidth
+          && upper.x >= std::min(dimensions.x, (cx + 1) * cellWidth);
+
+        vec2f &range = cellRanges[cx + gridDimensions.x *
+                                  (cell.y + size_t(gridDimensions.y) * cell.z)];
+        if (covers && rowCellRange[i].x > rowCellRange[i].y) {
+          range = vec2f(99999.0f, -99999.0f);
+        } else if (covers) {
+          range = rowCellRange[i];
+        } else {
+          range.x = std::min(range.x, rowCellRange[i].x);
+          range.y = std::max(range.y, rowCellRange[i].y);
+        }
+        myRange.x = std::min(myRange.x, rowCellRange[i].x);
+        myRange.y = std::max(myRange.y, rowCellRange[i].y);
+      }
+      taskRange[taskIndex] = myRange;
+    });
+
+    for (int i = 0; i < numTasks; i++) {
+      voxelRange.x = std::min(voxelRange.x, taskRange[i].x);
+      voxelRange.y = std::max(voxelRange.y, taskRange[i].y);
+    }
+  }
+
 } // ::ospray
 
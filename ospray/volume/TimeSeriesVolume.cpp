@@ -0,0 +1,245 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+//ospray
+#include "common/tasking/async.h"
+#include "volume/TimeSeriesVolume.h"
+#include "TimeSeriesVolume_ispc.h"
+// std
+#include <cstdio>
+#include <vector>
+
+namespace ospray {
+
+  TimeSeriesVolume::TimeSeriesVolume() :
+    dimensions(0),
+    timeStepCount(0)
+  {
+  }
+
+  std::string TimeSeriesVolume::toString() const
+  {
+    return("ospray::TimeSeriesVolume<" + voxelType + ">");
+  }
+
+  void TimeSeriesVolume::commit()
+  {
+    // The series itself can only be set up once.
+    if (ispcEquivalent == nullptr) {
+      fileNamePattern = getParamString("filename", "");
+      exitOnCondition(fileNamePattern.empty(),
+                      "no filename specified for the time series volume");
+
+      voxelType = getParamString("voxelType", "unspecified");
+      exitOnCondition(typeForString(voxelType.c_str()) == OSP_UNKNOWN,
+                      "unrecognized voxel type");
+
+      dimensions = getParam3i("dimensions", vec3i(0));
+      exitOnCondition(reduce_min(dimensions) <= 0,
+                      "invalid volume dimensions");
+
+      timeStepCount = getParam1i("timeStepCount", 0);
+      exitOnCondition(timeStepCount <= 0, "invalid timeStepCount");
+
+      ispcEquivalent = ispc::TimeSeriesVolume_createInstance(this);
+    }
+
+    updateEditableParameters();
+
+    // The current step, and the blend weight of the one after it.
+    const float time = std::min(std::max(getParam1f("timeStep", 0.f), 0.f),
+                                float(timeStepCount - 1));
+    const bool interpolation = getParam1i("interpolation", 0);
+    const int current = int(time);
+    const float alpha = interpolation ? time - current : 0.f;
+
+    // The window covers the current step and the ones played next (wrapping
+    // around at the end of the series), steps outside of it get released.
+    // The ISPC volume may still point to an evicted step, so they are kept
+    // alive until it has been re-pointed below.
+    const int windowSize = std::min(timeStepCount,
+                                    std::max(getParam1i("windowSize", 3),
+                                             interpolation ? 2 : 1));
+    std::vector<std::shared_ptr<TimeStep>> evicted;
+    for (auto it = window.begin(); it != window.end();) {
+      const int distance = (it->first - current + timeStepCount) % timeStepCount;
+      if (distance >= windowSize) {
+        evicted.push_back(it->second);
+        it = window.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    for (int i = 0; i < windowSize; i++)
+      requestTimeStep((current + i) % timeStepCount);
+
+    // Swap in the steps needed for this frame, waiting for them if the
+    // prefetching did not keep up.
+    Volume *step0 = acquireTimeStep(current);
+    Volume *step1 = alpha > 0.f ? acquireTimeStep(current + 1) : nullptr;
+
+    ispc::TimeSeriesVolume_setTimeSteps(ispcEquivalent,
+                                        step0->getIE(),
+                                        step1 ? step1->getIE() : nullptr,
+                                        alpha);
+
+    // Nothing refers to the evicted steps anymore.
+    evicted.clear();
+
+    // Make the bounding box visible to the application.
+    Volume::finish();
+  }
+
+  int TimeSeriesVolume::setRegion(const void *, const vec3i &, const vec3i &)
+  {
+    std::cerr << "#osp:time_series_volume: ospSetRegion() is not supported, "
+              << "the voxels are read from the timestep files" << std::endl;
+    return 0;
+  }
+
+  void TimeSeriesVolume::requestTimeStep(int index)
+  {
+    if (window.count(index))
+      return;
+
+    const std::string stepVolumeType
+      = getParamString("stepVolumeType", "block_bricked_volume");
+
+    std::shared_ptr<TimeStep> step = std::make_shared<TimeStep>();
+    step->volume = Volume::createInstance(stepVolumeType);
+    exitOnCondition(!step->volume,
+                    "unrecognized stepVolumeType '" + stepVolumeType + "'");
+
+    // Parameters are only ever set on the commit thread, before and after
+    // the step is loaded.
+    copyParameters(step->volume.ptr);
+    window[index] = step;
+
+    // The task only gets copies, the series may be gone by the time it runs.
+    const std::string fileName = fileNameOf(index);
+    const std::string stepVoxelType = voxelType;
+    const vec3i stepDimensions = dimensions;
+    async([=]() {
+      loadTimeStep(step, fileName, stepVoxelType, stepDimensions);
+    });
+  }
+
+  Volume *TimeSeriesVolume::acquireTimeStep(int index)
+  {
+    std::shared_ptr<TimeStep> step = window[index];
+    Assert(step);
+
+    {
+      std::unique_lock<std::mutex> lock(step->mutex);
+      step->loadedCondition.wait(lock, [&]{ return step->loaded; });
+    }
+
+    exitOnCondition(step->failed, "unable to read timestep file '"
+                    + fileNameOf(index) + "'");
+
+    // The first commit builds the accelerator of the step, later ones pick
+    // up changes of the editable parameters.
+    copyParameters(step->volume.ptr);
+    step->volume->commit();
+
+    return step->volume.ptr;
+  }
+
+  void TimeSeriesVolume::loadTimeStep(std::shared_ptr<TimeStep> step,
+                                      std::string fileName,
+                                      std::string voxelType,
+                                      vec3i dimensions)
+  {
+    bool success = false;
+
+    try {
+      FILE *file = fopen(fileName.c_str(), "rb");
+      if (file) {
+        // Read and brick the voxels in slabs of slices, so no copy of the
+        // whole step is needed.
+        const size_t sliceSize = sizeOf(typeForString(voxelType.c_str()))
+          * size_t(dimensions.x) * size_t(dimensions.y);
+        const int slabSlices
+          = std::min<size_t>(dimensions.z,
+                             std::max<size_t>(1, (64*1024*1024) / sliceSize));
+        std::vector<unsigned char> slab(sliceSize * slabSlices);
+
+        success = true;
+        for (int z = 0; success && z < dimensions.z; z += slabSlices) {
+          const int slices = std::min(slabSlices, dimensions.z - z);
+          success = fread(slab.data(), sliceSize, slices, file) == size_t(slices);
+          if (success)
+            step->volume->setRegion(slab.data(), vec3i(0, 0, z),
+                                    vec3i(dimensions.x, dimensions.y, slices));
+        }
+
+        fclose(file);
+      }
+    } catch (const std::exception &e) {
+      std::cerr << "#osp:time_series_volume: loading '" << fileName
+                << "' failed: " << e.what() << std::endl;
+      success = false;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(step->mutex);
+      step->loaded = true;
+      step->failed = !success;
+    }
+    step->loadedCondition.notify_all();
+  }
+
+  std::string TimeSeriesVolume::fileNameOf(int index) const
+  {
+    char fileName[4096];
+    snprintf(fileName, sizeof(fileName), fileNamePattern.c_str(), index);
+    return fileName;
+  }
+
+  void TimeSeriesVolume::copyParameters(Volume *volume) const
+  {
+    static const char *names[] = {
+      "dimensions", "voxelType", "voxelRange", "gridOrigin", "gridSpacing",
+      "transferFunction", "gradientShadingEnabled", "samplingRate",
+      "adaptiveSampling", "adaptiveScalar", "adaptiveMinSamplingRate",
+      "adaptiveMaxSamplingRate", "volumeClippingBoxLower",
+      "volumeClippingBoxUpper"
+    };
+
+    for (const char *name : names) {
+      Param *param = const_cast<TimeSeriesVolume *>(this)->findParam(name);
+      if (param == nullptr)
+        continue;
+
+      Param *target = volume->findParam(name, true);
+      if (param->type == OSP_OBJECT || param->type == OSP_DATA)
+        target->set(param->ptr);
+      else if (param->type == OSP_STRING)
+        target->set(param->s);
+      else {
+        target->clear();
+        target->type = param->type;
+        memcpy(target->ui, param->ui, sizeof(param->ui));
+      }
+    }
+  }
+
+  // A volume playing back a series of timesteps stored in raw voxel files.
+  OSP_REGISTER_VOLUME(TimeSeriesVolume, time_series_volume);
+
+} // ::ospray
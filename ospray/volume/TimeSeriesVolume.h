@@ -0,0 +1,116 @@
+// ======================================================================== //
+// Copyright 2009-2016 Intel Corporation                                    //
+//                                                                          //
+// Licensed under the Apache License, Version 2.0 (the "License");          //
+// you may not use this file except in compliance with the License.         //
+// You may obtain a copy of the License at                                  //
+//                                                                          //
+//     http://www.apache.org/licenses/LICENSE-2.0                           //
+//                                                                          //
+// Unless required by applicable law or agreed to in writing, software      //
+// distributed under the License is distributed on an "AS IS" BASIS,        //
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. //
+// See the License for the specific language governing permissions and      //
+// limitations under the License.                                           //
+// ======================================================================== //
+
+
+#pragma once
+
+#include "volume/Volume.h"
+// std
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace ospray {
+
+  //! \brief A volume that plays back a series of timesteps, each stored in
+  //!  its own raw voxel file.
+  //!
+  //!  Only a window of timesteps is kept in memory: committing the volume
+  //!  with a new 'timeStep' swaps in the requested step(s) and starts
+  //!  loading and bricking the following ones on background threads (using
+  //!  ospray::async), so playback does not stall on file I/O. Each step is
+  //!  a volume of type 'stepVolumeType' (block_bricked_volume by default).
+  //!  With 'interpolation' enabled a fractional 'timeStep' blends the two
+  //!  adjacent steps.
+  //!
+  //!  Parameters:
+  //!    filename       printf() pattern with one integer for the step index
+  //!    timeStepCount  number of timesteps
+  //!    dimensions     voxels per dimension (all steps)
+  //!    voxelType      voxel type of the files
+  //!    timeStep       current time (float, in steps)
+  //!    windowSize     number of steps kept in memory (default 3)
+  //!    interpolation  blend adjacent steps (default off)
+  //!  plus the grid and editable parameters of structured volumes.
+  //!
+  class TimeSeriesVolume : public Volume {
+  public:
+
+    TimeSeriesVolume();
+
+    //! A string description of this class.
+    std::string toString() const override;
+
+    //! Swap in the current timestep(s) and prefetch the next ones.
+    void commit() override;
+
+    //! The voxels of this volume type come from its files only.
+    int setRegion(const void *source,
+                  const vec3i &index,
+                  const vec3i &count) override;
+
+  private:
+
+    //! A timestep in the window, loaded in the background.
+    struct TimeStep {
+      //! The volume holding the voxels of this step.
+      Ref<Volume> volume;
+      //! Set once the voxels have been read and bricked.
+      bool loaded {false};
+      //! Set if the file could not be read.
+      bool failed {false};
+      //! Protects 'loaded' and 'failed'.
+      std::mutex mutex;
+      //! Signalled once the step finished loading.
+      std::condition_variable loadedCondition;
+    };
+
+    //! Start loading the given step if it is not in the window yet.
+    void requestTimeStep(int index);
+
+    //! Wait until the given step is loaded, and commit it.
+    Volume *acquireTimeStep(int index);
+
+    //! Read the file of a step into its volume (runs on a background thread).
+    static void loadTimeStep(std::shared_ptr<TimeStep> step,
+                             std::string fileName,
+                             std::string voxelType,
+                             vec3i dimensions);
+
+    //! The file name of the given step.
+    std::string fileNameOf(int index) const;
+
+    //! Pass the grid and editable parameters on to the volume of a step.
+    void copyParameters(Volume *volume) const;
+
+    //! Printf() pattern of the step files.
+    std::string fileNamePattern;
+
+    //! Voxel type of the step files.
+    std::string voxelType;
+
+    //! Volume size in voxels per dimension.
+    vec3i dimensions;
+
+    //! Number of timesteps in the series.
+    int timeStepCount;
+
+    //! The timesteps kept in memory, by step index.
+    std::map<int, std::shared_ptr<TimeStep>> window;
+  };
+
+} // ::ospray
@@ -127,6 +127,18 @@ namespace ospray {
     ispc::Volume_setSamplingRate(ispcEquivalent,
                                  getParam1f("samplingRate", 1.0f));
 
+    // Set the adaptive sampling parameters: the sampling rate follows the
+    // transfer function opacity and value variation of the data around each
+    // sample, bounded by the min/max rates.
+    const float minRate = getParam1f("adaptiveMinSamplingRate", 0.25f);
+    const float maxRate = getParam1f("adaptiveMaxSamplingRate", 2.0f);
+    exitOnCondition(minRate <= 0.f || maxRate < minRate,
+                    "invalid adaptive sampling rate bounds");
+    ispc::Volume_setAdaptiveSampling(ispcEquivalent,
+                                     getParam1i("adaptiveSampling", 0),
+                                     getParam1f("adaptiveScalar", 15.0f),
+                                     minRate, maxRate);
+
     // Set the transfer function.
     TransferFunction *transferFunction =
         (TransferFunction *) getParamObject("transferFunction", NULL);